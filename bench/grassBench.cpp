@@ -0,0 +1,25 @@
+#include "application.hpp"
+#include "options.hpp"
+
+#include <cstdlib>
+#include <string>
+
+/**
+ * Replay a camera path offscreen with a fixed time step and write the per frame times and counters as json
+ * The options are the ones of the application, --headless is implied and the results go to grassBench.json by default
+*/
+int main(int argc, char** argv){
+
+    ApplicationOptions options = ApplicationOptions::parse(argc, argv);
+    options._Headless = true;
+    if(options._BenchOutput.empty()){
+        options._BenchOutput = "grassBench.json";
+    }
+
+    Application app(options);
+    app.init();
+    app.run();
+    app.quit();
+
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,88 @@
+#include "camera.hpp"
+#include "frustum.hpp"
+#include "grassBlade.hpp"
+#include "tileQuadtree.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+// every allocation of the process goes through these operators
+static std::atomic<size_t> _NbAllocations(0);
+
+void* operator new(size_t size){
+    _NbAllocations++;
+    void* ptr = malloc(size);
+    if(ptr == nullptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept{
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept{
+    free(ptr);
+}
+
+/**
+ * Evaluate the tiles of a 100x100 field with a turning camera
+ * Fails if a frame allocates
+*/
+int main(){
+    const GLuint nbTileLength = 100;
+    const GLuint tileSize = 4;
+    const int nbWarmupFrames = 10;
+    const int nbFrames = 1000;
+
+    std::vector<glm::vec3> minCorners;
+    std::vector<glm::vec3> maxCorners;
+    for(GLuint line=0; line<nbTileLength; line++){
+        for(GLuint col=0; col<nbTileLength; col++){
+            glm::vec3 pos = glm::vec3(col * tileSize, 0.f, line * tileSize);
+            glm::vec3 reach = glm::vec3(_MAX_BLADE_REACH, 0.f, _MAX_BLADE_REACH);
+            glm::vec3 top = glm::vec3(tileSize, _MAX_BLADE_TOP, tileSize);
+            minCorners.push_back(pos - reach);
+            maxCorners.push_back(pos + top + reach);
+        }
+    }
+    TileQuadtree tiles;
+    tiles.build(nbTileLength, nbTileLength, minCorners, maxCorners);
+
+    float center = 0.5f * nbTileLength * tileSize;
+    Camera camera(glm::vec3(center, 2.f, center), 16.f / 9.f);
+
+    double totalTime = 0.;
+    double maxTime = 0.;
+    size_t nbVisibleTiles = 0;
+    size_t nbAllocations = 0;
+    for(int frame=0; frame<nbWarmupFrames + nbFrames; frame++){
+        camera.ProcessMouseMovement(1.f, 0.f);
+        Frustum frustum = camera.createFrustrum();
+
+        size_t allocationsBefore = _NbAllocations;
+        auto start = std::chrono::high_resolution_clock::now();
+        tiles.evaluate(camera.getPosition(), frustum, 30.f, 8192, 256);
+        auto end = std::chrono::high_resolution_clock::now();
+        if(frame < nbWarmupFrames) continue;
+
+        nbAllocations += _NbAllocations - allocationsBefore;
+        double time = std::chrono::duration<double, std::micro>(end - start).count();
+        totalTime += time;
+        maxTime = std::max(maxTime, time);
+        nbVisibleTiles += tiles.getArrays()._VisibleTiles.size();
+    }
+
+    fprintf(stdout, "Tiles: %u, nodes: %u\n", tiles.getArrays().size(), tiles.getNbNodes());
+    fprintf(stdout, "Visible tiles per frame: %.1f\n", double(nbVisibleTiles) / nbFrames);
+    fprintf(stdout, "Time per frame: avg %.1f us, max %.1f us\n", totalTime / nbFrames, maxTime);
+    fprintf(stdout, "Allocations per frame: %.2f\n", double(nbAllocations) / nbFrames);
+
+    if(nbAllocations != 0){
+        fprintf(stderr, "The tiles evaluation allocated %zu times!\n", nbAllocations);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -3,7 +3,7 @@
 
 int main(int argc, char** argv){
 
-    Application app;
+    Application app(ApplicationOptions::parse(argc, argv));
     app.init();
     app.run();
     app.quit();
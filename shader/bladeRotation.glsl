@@ -0,0 +1,12 @@
+// included by the shaders packing or unpacking the blades, must match GrassBlade (grassBlade.hpp)
+
+const float PI = 3.14159265f;
+
+// the rotation in [0, 2pi[ is stored on the 16 high bits of bendYRotation
+uint packRotation(float rotation){
+    return uint(rotation * (65536.f / (2.f * PI))) & 0xffffu;
+}
+
+float unpackRotation(uint bendYRotation){
+    return float(bendYRotation >> 16) * (2.f * PI / 65536.f);
+}
@@ -0,0 +1,26 @@
+// segments of the blades, shared by the blade expansions and the compaction (grassCompact.glsl)
+// camPos, segmentScale and MAX_NB_SEGMENTS must be declared before the include
+
+// continuous number of segments from the projected height of the blade
+float getNbSegments(vec3 base, float height){
+    float dist = max(distance(camPos, base + vec3(0.f, 0.5f * height, 0.f)), 1e-3f);
+    return clamp(height * segmentScale / dist, 1.f, float(MAX_NB_SEGMENTS));
+}
+
+// rows of the strip under the tip
+int getNbRows(float nbSegments){
+    return int(ceil(nbSegments));
+}
+
+// position t along the blade and width factor of a row, row 0 at the base
+// the last row grows out of the tip with the fraction of the segment count: it starts with no width
+// at the tip and slides down to its place as it widens, so the levels morph into each other
+vec2 getRowShape(int row, float nbSegments){
+    float t = min(float(row) / nbSegments, 1.f);
+    float widthScale = 1.f - 0.2f * t;
+    int nbRows = getNbRows(nbSegments);
+    if(row == nbRows - 1){
+        widthScale *= nbSegments - float(nbRows - 1);
+    }
+    return vec2(t, widthScale);
+}
@@ -0,0 +1,150 @@
+#version 450 core
+
+// Buffers and layouts
+
+// x: blades of the tile, y: visible draws (packed at the front of the draw commands)
+layout (local_size_x = 64, local_size_y = 1, local_size_z = 1) in;
+
+// packed blade record, must match GrassBlade (grassBlade.hpp)
+struct Blade{
+    float posX;
+    float posZ;
+    uint heightWidth;       // half2(height, width)
+    uint tiltBendX;         // half2(tilt, bend.x)
+    uint bendYRotation;     // half(bend.y) | 16 bits angle << 16
+    uint clump;             // index in the clump table
+};
+
+layout(binding = 0, std430) readonly buffer BladesBuffer {
+    Blade blades[];
+};
+
+struct DrawInfo{
+    uint startId;
+    uint tileId;
+    uint nbBlades;
+};
+
+struct DrawCommand{
+    uint count;
+    uint instanceCount;
+    uint first;
+    uint baseInstance;
+};
+
+layout(binding = 7, std430) readonly buffer DrawInfosBuffer {
+    DrawInfo drawInfos[];
+};
+
+layout(binding = 10, std430) buffer CullCountersBuffer {
+    uint nbGroupsX;
+    uint nbGroupsY;
+    uint nbGroupsZ;
+    uint nbTriangles;   // triangles of the visible blades, read back by the triangle budget
+    uint nbBlades;      // visible blades, read back by the benchmarks
+};
+
+layout(binding = 11, std430) buffer DrawCommandsBuffer {
+    DrawCommand drawCommands[];
+};
+
+layout(binding = 13, std430) writeonly buffer VisibleBladesBuffer {
+    uint visibleBlades[];   // packed per draw, starting at the draw's startId
+};
+
+
+
+// per frame data, must match FrameUniformsData (frameUniforms.hpp)
+layout(std140, binding = 0) uniform FrameUniformsBlock{
+    mat4 view;
+    mat4 proj;
+    vec3 camPos;
+    float time;
+    vec4 frustumPlanes[6];  // normal and distance to the origin
+};
+
+// Uniform variables
+uniform float radiusRender;
+// count the instances of the vertex pulling pipeline instead of the points
+uniform bool bladesAsInstances;
+// number of segments of a blade per meter of height at 1 meter from the camera
+uniform float segmentScale;
+
+const int MAX_NB_SEGMENTS = 7;
+
+// bounds of the animation in the geometry shader
+const float MAX_WIND_DISPLACEMENT = 1.f;
+const vec2 MAX_ANIMATION_DISPLACEMENT = vec2(0.1f, 0.05f);
+
+
+// Helper functions
+
+// the blade can rotate freely around its base so the sphere covers every rotation
+vec4 getBoundingSphere(uint bladeId){
+    Blade blade = blades[bladeId];
+    vec3 base = vec3(blade.posX, 0.f, blade.posZ);
+    vec2 heightWidth = unpackHalf2x16(blade.heightWidth);
+    vec2 tiltBendX = unpackHalf2x16(blade.tiltBendX);
+    float height = heightWidth.x;
+    float reach = max(tiltBendX.x, tiltBendX.y);
+
+    vec2 extent = vec2(reach + MAX_WIND_DISPLACEMENT, 0.5f * height) + MAX_ANIMATION_DISPLACEMENT;
+    float radius = length(extent) + heightWidth.y;
+
+    return vec4(base + vec3(0.f, 0.5f * height, 0.f), radius);
+}
+
+bool isSphereInFrustum(vec4 sphere){
+    for(int i=0; i<6; i++){
+        if(dot(frustumPlanes[i].xyz, sphere.xyz) - frustumPlanes[i].w < -sphere.w){
+            return false;
+        }
+    }
+    return true;
+}
+
+bool isSphereInRenderRadius(vec4 sphere){
+    return distance(sphere.xz, camPos.xz) - sphere.w <= radiusRender;
+}
+
+#include "bladeSegments.glsl"
+
+shared uint groupTriangles;
+shared uint groupBlades;
+
+
+
+void main() {
+    uint drawId = gl_WorkGroupID.y;
+    DrawInfo info = drawInfos[drawId];
+
+    if(gl_LocalInvocationID.x == 0){
+        groupTriangles = 0u;
+        groupBlades = 0u;
+    }
+    barrier();
+
+    uint blade = gl_WorkGroupID.x * gl_WorkGroupSize.x + gl_LocalInvocationID.x;
+    uint bladeId = info.startId + blade;
+    vec4 sphere = blade < info.nbBlades ? getBoundingSphere(bladeId) : vec4(0.f);
+    if(blade < info.nbBlades && isSphereInRenderRadius(sphere) && isSphereInFrustum(sphere)){
+        uint visibleId = bladesAsInstances 
+            ? atomicAdd(drawCommands[drawId].instanceCount, 1u)
+            : atomicAdd(drawCommands[drawId].count, 1u);
+        visibleBlades[info.startId + visibleId] = bladeId;
+
+        // a strip of n segments has 2n-1 triangles
+        Blade bladeData = blades[bladeId];
+        float height = unpackHalf2x16(bladeData.heightWidth).x;
+        uint nbSegments = uint(getNbRows(getNbSegments(vec3(bladeData.posX, 0.f, bladeData.posZ), height)));
+        atomicAdd(groupTriangles, 2u * nbSegments - 1u);
+        atomicAdd(groupBlades, 1u);
+    }
+
+    // one global atomic per group
+    barrier();
+    if(gl_LocalInvocationID.x == 0){
+        atomicAdd(nbTriangles, groupTriangles);
+        atomicAdd(nbBlades, groupBlades);
+    }
+}
\ No newline at end of file
@@ -4,48 +4,60 @@
 
 layout (local_size_x = 1, local_size_y = 1, local_size_z = 1) in;
 
-layout(binding = 0, std430) buffer PositionsBuffer {
-    vec4 positions[];
+// packed blade record, must match GrassBlade (grassBlade.hpp)
+struct Blade{
+    float posX;
+    float posZ;
+    uint heightWidth;       // half2(height, width)
+    uint tiltBendX;         // half2(tilt, bend.x)
+    uint bendYRotation;     // half(bend.y) | 16 bits angle << 16
+    uint clump;             // index in the clump table
 };
 
-layout(binding = 1, std430) buffer HeightsBuffer {
-    float heights[];
+layout(binding = 0, std430) writeonly buffer BladesBuffer {
+    Blade blades[];
 };
 
-layout(binding = 2, std430) buffer WidthsBuffer {
-    float widths[];
+// parameters shared by the blades of a clump
+struct Clump{
+    vec4 color;
 };
 
-layout(binding = 3, std430) buffer ColorsBuffer {
-    vec4 colors[];
+layout(binding = 1, std430) writeonly buffer ClumpsBuffer {
+    Clump clumps[];     // table of each slot starts at parallelId * nbClumpsPerTile
 };
 
-layout(binding = 4, std430) buffer RotationsBuffer {
-    float rotations[];
-};
 
-layout(binding = 5, std430) buffer TiltBuffer {
-    float tilts[];
+// parameters of each tile, must match GrassTileParams (grass.hpp)
+struct TileParams{
+    vec2 tilePos;
+    int tileWidth;
+    int tileHeight;
+    int gridNbCols;
+    int gridNbLines;
+    int tileID;
+    int padding;
 };
 
-layout(binding = 6, std430) buffer BendBuffer {
-    vec2 bends[];
+layout(binding = 14, std430) readonly buffer TileParamsBuffer {
+    TileParams tileParams[];    // indexed by the tile's index in the grid
 };
 
-
+// parameters of the generated tile, read from the tile params in main
+int tileWidth;
+int tileHeight;
+int gridNbCols;
+int gridNbLines;
+vec2 tilePos;
+int tileID;
 
 // Uniform variables
-uniform int tileWidth;
-uniform int tileHeight;
-uniform int gridNbCols;
-uniform int gridNbLines;
-uniform vec2 tilePos;
-uniform int tileID;
-
+uniform int tileIndex;
 uniform int parallelId;
 uniform int nbBladesPerTile;
+uniform int nbClumpsPerTile;
 
-const float PI = 3.1416f;
+#include "bladeRotation.glsl"
 
 const float MAX_WIDTH = 0.05f;
 const float MIN_WIDTH = 0.02f;
@@ -57,6 +69,7 @@ const float MIN_GREEN = 0.5f;
 
 
 // Helper functions
+// BladeGenerator (bladeGenerator.cpp) is the CPU reference of this shader, keep them in sync
 
 // generate random value given a vec2 seed
 float rand(vec2 co){
@@ -67,13 +80,13 @@ float rand(vec2 co, float mini, float maxi){
     return random * (maxi - mini) + mini;
 }
 
-// return the id of the grid cell given a position
+// return the id of the grid cell given a position in the tile
 uint getGridCell(vec2 position){
     float cellWidth = (1.f*tileWidth) / gridNbCols;
     float cellHeight = (1.f*tileHeight) / gridNbLines;
 
-    uint cellX = uint(floor(position.x / cellWidth));
-    uint cellY = uint(floor(position.y / cellHeight));
+    uint cellX = min(uint(floor(position.x / cellWidth)), uint(gridNbCols - 1));
+    uint cellY = min(uint(floor(position.y / cellHeight)), uint(gridNbLines - 1));
 
     return cellX + cellY * gridNbCols;
 }
@@ -83,15 +96,15 @@ bool cellIsFirstRow(uint cellId){
 }
 
 bool cellIsLastRow(uint cellId){
-    return cellId > gridNbCols*(gridNbLines-1);
+    return cellId >= gridNbCols*(gridNbLines-1);
 }
 
 bool cellIsFirstCol(uint cellId){
-    return (cellId % gridNbLines) == 0;
+    return (cellId % gridNbCols) == 0;
 }
 
 bool cellIsLastCol(uint cellId){
-    return (cellId % gridNbLines) == (gridNbCols-1);
+    return (cellId % gridNbCols) == (gridNbCols-1);
 }
 
 // return the ids of the closest intersections to the blade position and return the number of neighbors to check
@@ -151,9 +164,13 @@ vec2 getIntersectionPosition(uint cellId){
     float randZ = rand(vec2(tileID, cellId));
 
     float cellX = cellId % gridNbCols;
-    float cellZ = cellId / gridNbLines;
+    float cellZ = cellId / gridNbCols;
 
-    return vec2(cellX+randX, cellZ+randZ);
+    // same space as the blades positions
+    float cellWidth = (1.f*tileWidth) / gridNbCols;
+    float cellHeight = (1.f*tileHeight) / gridNbLines;
+
+    return vec2((cellX+randX) * cellWidth, (cellZ+randZ) * cellHeight);
 }
 
 // return the jittered positions of the closest intersections to the blade position
@@ -184,7 +201,7 @@ uint findNearestNeighbour(vec3 bladePosition, uint nbIntersections, vec2 voronoi
 
 // Main functions
 
-// give a random position in the tile for the blade
+// give a random position in the tile for the blade, relative to the tile
 vec4 getRandomPosition(vec2 seed1, vec2 seed2){
     vec4 newPos = vec4(0.f, 0.f, 0.f, 1.f);
 
@@ -206,9 +223,7 @@ vec4 getRandomPosition(vec2 seed1, vec2 seed2){
     newPos.x = randX * float(tileWidth);
     newPos.z = randZ * float(tileHeight);
 
-    vec4 curTilePos = vec4(tilePos.x, 0.f, tilePos.y, 1.f);
-
-    return newPos + curTilePos;
+    return newPos;
 }
 
 // find the clump in which the grass blade is
@@ -257,7 +272,28 @@ vec2 getBend(vec2 seed1, vec2 seed2, float height, float tilt){
     return vec2(randX, randY);
 }
 
+Blade packBlade(vec4 position, float height, float width, uint clump, float rotation, float tilt, vec2 bend){
+    uint angle = packRotation(rotation);
+    uint bendY = packHalf2x16(vec2(bend.y, 0.f));
+    return Blade(
+        position.x,
+        position.z,
+        packHalf2x16(vec2(height, width)),
+        packHalf2x16(vec2(tilt, bend.x)),
+        bendY | (angle << 16),
+        clump
+    );
+}
+
 void main() {
+    TileParams tile = tileParams[tileIndex];
+    tileWidth = tile.tileWidth;
+    tileHeight = tile.tileHeight;
+    gridNbCols = tile.gridNbCols;
+    gridNbLines = tile.gridNbLines;
+    tilePos = tile.tilePos;
+    tileID = tile.tileID;
+
     uvec3 globalID = gl_GlobalInvocationID;
     int instanceIndex = int(globalID.x) 
                         + int(globalID.y) * int(gl_NumWorkGroups.x);
@@ -266,11 +302,12 @@ void main() {
     int bufferIndex = instanceIndex + (parallelId * nbBladesPerTile);
 
     // Store data in buffers
-    vec4 position = getRandomPosition(vec2(instanceIndex, tileID), vec2(tileID, instanceIndex));
-    uint clumpId = getClumpId(position.xyz);
+    // the clumps grid is in the tile's space
+    vec4 tilePosition = getRandomPosition(vec2(instanceIndex, tileID), vec2(tileID, instanceIndex));
+    uint clumpId = getClumpId(tilePosition.xyz);
+    vec4 position = tilePosition + vec4(tilePos.x, 0.f, tilePos.y, 0.f);
     float height = rand(position.xz, MIN_HEIGHT, MAX_HEIGHT);
     float width = rand(position.xz, MIN_WIDTH, MAX_WIDTH);
-    vec4 color = getColor(vec2(clumpId, clumpId));
     float rotation = getRotation(vec2(position.x*position.z, clumpId));
     float tilt = getTilt(vec2(clumpId, position.x*position.z), height);
     vec2 bend = getBend(vec2(clumpId, position.x), vec2(position.z, clumpId), height, tilt);
@@ -284,13 +321,13 @@ void main() {
     // float tilt = 0.f;
     // vec2 bend = vec2(instanceIndex+1.f, 0.f);
 
+    // the first invocations fill the clump table of the tile
+    uint clumpsStart = uint(parallelId * nbClumpsPerTile);
+    if(instanceIndex < gridNbCols * gridNbLines){
+        clumps[clumpsStart + uint(instanceIndex)] = Clump(getColor(vec2(instanceIndex, instanceIndex)));
+    }
+
     instanceIndex = bufferIndex;
 
-    positions[instanceIndex] = position;
-    heights[instanceIndex] = height;
-    widths[instanceIndex] = width;
-    colors[instanceIndex] = color;
-    rotations[instanceIndex] = rotation;
-    tilts[instanceIndex] = tilt;
-    bends[instanceIndex] = bend;
+    blades[instanceIndex] = packBlade(position, height, width, clumpsStart + clumpId, rotation, tilt, bend);
 }
\ No newline at end of file
@@ -0,0 +1,128 @@
+#version 450 core
+
+// Buffers and layouts
+
+// one invocation per slot of the blade cache
+layout (local_size_x = 64, local_size_y = 1, local_size_z = 1) in;
+
+struct TileBounds{
+    vec4 minCorner;
+    vec4 maxCorner;
+};
+
+struct DrawInfo{
+    uint startId;
+    uint tileId;
+    uint nbBlades;
+};
+
+struct DrawCommand{
+    uint count;
+    uint instanceCount;
+    uint first;
+    uint baseInstance;
+};
+
+layout(binding = 7, std430) writeonly buffer DrawInfosBuffer {
+    DrawInfo drawInfos[];
+};
+
+layout(binding = 8, std430) readonly buffer TileBoundsBuffer {
+    TileBounds tileBounds[];
+};
+
+layout(binding = 9, std430) readonly buffer SlotTilesBuffer {
+    int slotTiles[];    // tile id of each slot, -1 if free
+};
+
+layout(binding = 10, std430) buffer CullCountersBuffer {
+    uint nbGroupsX;     // indirect dispatch of the blades compaction
+    uint nbGroupsY;     // number of visible draws
+    uint nbGroupsZ;
+    uint nbTriangles;   // triangles of the visible blades
+    uint nbBlades;      // visible blades
+};
+
+layout(binding = 11, std430) writeonly buffer DrawCommandsBuffer {
+    DrawCommand drawCommands[];
+};
+
+
+
+// per frame data, must match FrameUniformsData (frameUniforms.hpp)
+layout(std140, binding = 0) uniform FrameUniformsBlock{
+    mat4 view;
+    mat4 proj;
+    vec3 camPos;
+    float time;
+    vec4 frustumPlanes[6];  // normal and distance to the origin
+};
+
+// Uniform variables
+uniform float radiusRender;
+
+uniform int firstTileId;
+uniform int nbSlots;
+uniform int nbBladesPerSlot;
+uniform int maxNbBlades;
+uniform int minNbBlades;
+
+// the vertex pulling pipeline draws one strip instance per blade
+uniform bool bladesAsInstances;
+uniform int nbVertPerBlade;
+
+
+// Helper functions
+
+vec3 getTileCenter(TileBounds bounds){
+    vec3 center = 0.5f * (bounds.minCorner.xyz + bounds.maxCorner.xyz);
+    return vec3(center.x, 0.f, center.z);
+}
+
+// distance to the closest point of the tile, null if the center is inside
+bool isCircleIntersectingTile(vec3 center, float radius, TileBounds bounds){
+    vec2 closest = clamp(center.xz, bounds.minCorner.xz, bounds.maxCorner.xz);
+    return distance(center.xz, closest) <= radius;
+}
+
+// the tile is outside if its p-vertex, the corner furthest along a plane's normal, is behind the plane
+bool isTileInFrustum(TileBounds bounds){
+    for(int i=0; i<6; i++){
+        vec3 pVertex = mix(bounds.minCorner.xyz, bounds.maxCorner.xyz, greaterThanEqual(frustumPlanes[i].xyz, vec3(0.f)));
+        if(dot(frustumPlanes[i].xyz, pVertex) - frustumPlanes[i].w < 0.f){
+            return false;
+        }
+    }
+    return true;
+}
+
+// less blades for the tiles far from the camera
+uint getNbBlades(vec3 groundCamPos, TileBounds bounds){
+    float dist = distance(groundCamPos, getTileCenter(bounds));
+    if(dist > radiusRender){
+        return uint(minNbBlades);
+    }
+    float alpha = dist / radiusRender;
+    return uint(maxNbBlades * (1.f - alpha) + minNbBlades * alpha);
+}
+
+
+
+void main() {
+    int slot = int(gl_GlobalInvocationID.x);
+    if(slot >= nbSlots) return;
+
+    int tileId = slotTiles[slot];
+    if(tileId < 0) return;
+
+    TileBounds bounds = tileBounds[tileId - firstTileId];
+    vec3 groundCamPos = vec3(camPos.x, 0.f, camPos.z);
+    if(!isCircleIntersectingTile(groundCamPos, radiusRender, bounds)) return;
+    if(!isTileInFrustum(bounds)) return;
+
+    uint drawId = atomicAdd(nbGroupsY, 1u);
+
+    // the blades compaction counts the blades to draw
+    drawCommands[drawId] = bladesAsInstances ? DrawCommand(uint(nbVertPerBlade), 0u, 0u, 0u) : DrawCommand(0u, 1u, 0u, 0u);
+    drawInfos[drawId] = DrawInfo(uint(slot * nbBladesPerSlot), uint(tileId), getNbBlades(groundCamPos, bounds));
+}
\ No newline at end of file
@@ -5,9 +5,14 @@ in vec3 geomFragNormal;
 in vec3 geomFragPos;
 // in float geomFragLod;
 
-uniform mat4 view;
-uniform mat4 proj;
-uniform vec3 camPos;
+// per frame data, must match FrameUniformsData (frameUniforms.hpp)
+layout(std140, binding = 0) uniform FrameUniformsBlock{
+    mat4 view;
+    mat4 proj;
+    vec3 camPos;
+    float time;
+    vec4 frustumPlanes[6];  // normal and distance to the origin
+};
 uniform float fAmbient;
 uniform float fDiffuse;
 uniform float fSpecular;
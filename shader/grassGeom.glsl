@@ -1,24 +1,43 @@
 #version 450 core
 
 layout (points) in;
-layout (triangle_strip, max_vertices = 45) out;
+layout (triangle_strip, max_vertices = 15) out;
 // layout (triangle_strip, max_vertices = 256) out;
 
-uniform mat4 view;
-uniform mat4 proj;
-uniform int tileLOD;
-
-const int HIGH_LOD = 1;
-const int NB_VERT_HIGH_LOD = 15;
-const int NB_QUAD_HIGH_LOD = 6;
-
-const int LOW_LOD = 2;
-const int NB_VERT_LOW_LOD = 3;
-const int NB_QUAD_LOW_LOD = 0;
+// per frame data, must match FrameUniformsData (frameUniforms.hpp)
+layout(std140, binding = 0) uniform FrameUniformsBlock{
+    mat4 view;
+    mat4 proj;
+    vec3 camPos;
+    float time;
+    vec4 frustumPlanes[6];  // normal and distance to the origin
+};
+
+// number of segments of a blade per meter of height at 1 meter from the camera
+uniform float segmentScale;
+
+const int MAX_NB_SEGMENTS = 7;
+
+// wind of the blades, set by WindField::getDefines (windField.hpp)
+// 0: wind texture, 1: simplex noise, 2: wind texture tinted by its difference with the noise
+#ifndef WIND_MODE
+#define WIND_MODE 0
+#endif
+#ifndef WIND_EXTENT
+#define WIND_EXTENT 80.0
+#endif
+#define WIND_MODE_ANALYTIC 1
+#define WIND_MODE_COMPARE 2
+
+#if WIND_MODE != WIND_MODE_ANALYTIC
+// window of WIND_EXTENT meters around the camera, wrapped around its edges
+layout(binding = 4) uniform sampler2D windTexture;
+#endif
+const int MAX_NB_VERT = 2 * MAX_NB_SEGMENTS + 1;
 
 const vec3 TIP_COLOR = vec3(0.5f, 0.5f, 0.1f);
 const vec4 red = vec4(1.f, 0.f, 0.f, 1.f);
-const float PI = 3.1416f;
+#include "bladeRotation.glsl"
 
 in VertexData{
     vec4 _Position;
@@ -35,11 +54,6 @@ out vec3 geomFragNormal;
 out vec3 geomFragPos;
 // out float geomFragLod;
 
-uniform vec3 camPos;
-uniform vec3 camAt;
-
-uniform float time;
-
 /* Gradient Perlin noise
 
 uniform int tileWidth;
@@ -112,224 +126,28 @@ float infinitePerlin(vec2 pos){
 }
 */
 
-// ************************************************ //
-// GLSL Simplex Noise
-// //
-// Description : Array and textureless GLSL 2D/3D/4D simplex
-// noise functions.
-// Author : Ian McEwan, Ashima Arts.
-// Maintainer : ijm
-// Lastmod : 20110822 (ijm)
-// License : Copyright (C) 2011 Ashima Arts. All rights reserved.
-// Distributed under the MIT License. See LICENSE file.
-// https://github.com/ashima/webgl-noise
-//
-// See: https://www.shadertoy.com/view/Mds3Wr
-// ************************************************ //
-float smooth_snoise(in vec2 v);
-float smooth_snoise(in vec3 v);
-float snoise(in vec2 v, int octaves) {
-	float res = 0.0;
-	float scale = 1.0;
-	for(int i=0; i<8; i++) {
-		if(i >= octaves) break;
-		res += smooth_snoise(v) * scale;
-		v *= vec2(2.0, 2.0);
-		scale *= 0.5;
-	}
-	return res;
-}
-
-float snoise(in vec3 v, int octaves) {
-	float res = 0.0;
-	float scale = 1.0;
-	for(int i=0; i<8; i++) {
-		if(i >= octaves) break;
-		res += smooth_snoise(v) * scale;
-		v *= vec3(2.0, 2.0, 2.0);
-		scale *= 0.5;
-	}
-	return res;
-}
-
-float snoise_abs(in vec2 v, int octaves) {
-	float res = 0.0;
-	float scale = 1.0;
-	for(int i=0; i<8; i++) {
-		if(i >= octaves) break;
-		res += abs(smooth_snoise(v)) * scale;
-		v *= vec2(2.0, 2.0);
-		scale *= 0.5;
-	}
-	return res;
-}
-
-float snoise_abs(in vec3 v, int octaves) {
-	float res = 0.0;
-	float scale = 1.0;
-	for(int i=0; i<8; i++) {
-		if(i >= octaves) break;
-		res += abs(smooth_snoise(v)) * scale;
-		v *= vec3(2.0, 2.0, 2.0);
-		scale *= 0.5;
-	}
-	return res;
-}
-
-vec3 mod289(in vec3 x) {
-    return x - floor(x * (1.0 / 289.0)) * 289.0;
-}
-
-vec2 mod289(in vec2 x) {
-    return x - floor(x * (1.0 / 289.0)) * 289.0;
-}
-
-vec3 permute(in vec3 x) {
-    return mod289(((x*34.0)+1.0)*x);
-}
+#include "windNoise.glsl"
 
-float smooth_snoise(in vec2 v){
-    const vec4 C = vec4(0.211324865405187,
-                        0.366025403784439, 
-                        -0.577350269189626,
-                        0.024390243902439);
-    // First corner
-    vec2 i = floor(v + dot(v, C.yy) );
-    vec2 x0 = v - i + dot(i, C.xx);
-
-    // Other corners
-    vec2 i1;
-    i1 = (x0.x > x0.y) ? vec2(1.0, 0.0) : vec2(0.0, 1.0);
-    vec4 x12 = x0.xyxy + C.xxzz;
-    x12.xy -= i1;
-
-    // Permutations
-    i = mod289(i);
-    vec3 p = permute( permute( i.y + vec3(0.0, i1.y, 1.0 ))
-    + i.x + vec3(0.0, i1.x, 1.0 ));
-
-    vec3 m = max(0.5 - vec3(dot(x0,x0), dot(x12.xy,x12.xy), dot(x12.zw,x12.zw)), 0.0);
-    m = m*m ;
-    m = m*m ;
-
-    vec3 x = 2.0 * fract(p * C.www) - 1.0;
-    vec3 h = abs(x) - 0.5;
-    vec3 ox = floor(x + 0.5);
-    vec3 a0 = x - ox;
-
-    m *= 1.79284291400159 - 0.85373472095314 * ( a0*a0 + h*h );
-
-    vec3 g;
-    g.x = a0.x * x0.x + h.x * x0.y;
-    g.yz = a0.yz * x12.xz + h.yz * x12.yw;
-    return 130.0 * dot(m, g);
+// [-1, 1]
+float getWind(vec2 pos, vec2 flowDirection){
+#if WIND_MODE == WIND_MODE_ANALYTIC
+    return windField(pos, time, flowDirection);
+#else
+    return textureLod(windTexture, pos / WIND_EXTENT, 0.f).r;
+#endif
 }
 
-vec4 mod289(in vec4 x) {
-    return x - floor(x * (1.0 / 289.0)) * 289.0;
-}
-
-vec4 permute(in vec4 x) {
-    return mod289(((x*34.0)+1.0)*x);
-}
+#if WIND_MODE == WIND_MODE_COMPARE
+const vec3 WIND_ERROR_COLOR = vec3(1.f, 0.f, 0.f);
+// difference between the texture and the noise shown at full color
+const float WIND_ERROR_RANGE = 0.05f;
 
-vec4 taylorInvSqrt(in vec4 r){
-    return 1.79284291400159 - 0.85373472095314 * r;
-}
-
-float smooth_snoise(in vec3 v){
-    const vec2 C = vec2(1.0/6.0, 1.0/3.0) ;
-    const vec4 D = vec4(0.0, 0.5, 1.0, 2.0);
-
-    // First corner
-    vec3 i = floor(v + dot(v, C.yyy) );
-    vec3 x0 = v - i + dot(i, C.xxx) ;
-
-    // Other corners
-    vec3 g = step(x0.yzx, x0.xyz);
-    vec3 l = 1.0 - g;
-    vec3 i1 = min( g.xyz, l.zxy );
-    vec3 i2 = max( g.xyz, l.zxy );
-
-    vec3 x1 = x0 - i1 + C.xxx;
-    vec3 x2 = x0 - i2 + C.yyy; 
-    vec3 x3 = x0 - D.yyy;
-
-    // Permutations
-    i = mod289(i);
-    vec4 p = permute( permute( permute(
-                i.z + vec4(0.0, i1.z, i2.z, 1.0 ))
-            + i.y + vec4(0.0, i1.y, i2.y, 1.0 ))
-            + i.x + vec4(0.0, i1.x, i2.x, 1.0 ));
-    float n_ = 0.142857142857;
-    vec3 ns = n_ * D.wyz - D.xzx;
-
-    vec4 j = p - 49.0 * floor(p * ns.z * ns.z);
-
-    vec4 x_ = floor(j * ns.z);
-    vec4 y_ = floor(j - 7.0 * x_ );
-
-    vec4 x = x_ *ns.x + ns.yyyy;
-    vec4 y = y_ *ns.x + ns.yyyy;
-    vec4 h = 1.0 - abs(x) - abs(y);
-
-    vec4 b0 = vec4( x.xy, y.xy );
-    vec4 b1 = vec4( x.zw, y.zw );
-
-    vec4 s0 = floor(b0)*2.0 + 1.0;
-    vec4 s1 = floor(b1)*2.0 + 1.0;
-    vec4 sh = -step(h, vec4(0.0));
-
-    vec4 a0 = b0.xzyw + s0.xzyw*sh.xxyy ;
-    vec4 a1 = b1.xzyw + s1.xzyw*sh.zzww ;
-
-    vec3 p0 = vec3(a0.xy,h.x);
-    vec3 p1 = vec3(a0.zw,h.y);
-    vec3 p2 = vec3(a1.xy,h.z);
-    vec3 p3 = vec3(a1.zw,h.w);
-
-    vec4 norm = taylorInvSqrt(vec4(dot(p0,p0), dot(p1,p1), dot(p2, p2), dot(p3,p3)));
-    p0 *= norm.x;
-    p1 *= norm.y;
-    p2 *= norm.z;
-    p3 *= norm.w;
-
-    vec4 m = max(0.6 - vec4(dot(x0,x0), dot(x1,x1), dot(x2,x2), dot(x3,x3)), 0.0);
-    m = m * m;
-    return 42.0 * dot( m*m, vec4( dot(p0,x0), dot(p1,x1),
-                                    dot(p2,x2), dot(p3,x3) ) );
-}
-// ************************************************ //
-
-
-float simplexPerlin(vec2 pos){
-    float alpha = 0.05f;
-    float beta = 0.65f;
-    float v1 = sin(pos.x);
-    float v2 = cos(pos.y);
-    // return beta*snoise_abs(vec2(v1,v2), 5);
-    return beta*snoise(vec2(v1,v2), 5);
-}
-
-float windField(vec2 uv, float dt, vec2 flowDirection) {
-    const float speed = 0.8f;  // Adjust the speed of the wind
-    const int octaves = 5;    // Adjust the number of octaves
-    const float persistence = .5f;  // Adjust the persistence of the noise
-    float scale = 1.f;  // Adjust the scale of the noise
-
-    vec2 movingUV = uv + flowDirection * dt * speed;
-    // generate wind field using multiple octaves of Simplex noise
-    float windFieldStrength = 0.f;
-    float amplitude = 1.f;
-
-    for (int i = 0; i < octaves; i++) {
-        windFieldStrength += amplitude * snoise(movingUV * scale, i);
-        scale /= 4.0f;  // Adjust the scale for each octave
-        amplitude *= persistence;  // Adjust the amplitude for each octave
-    }
-
-    return windFieldStrength; // [-1, 1]
+// tint of the blade by the difference between the texture and the noise, in [0, 1]
+float getWindError(vec2 pos, vec2 flowDirection){
+    float error = abs(getWind(pos, flowDirection) - windField(pos, time, flowDirection));
+    return clamp(error / WIND_ERROR_RANGE, 0.f, 1.f);
 }
+#endif
 
 
 mat3 getRotationMatrix(float rotation){
@@ -386,152 +204,80 @@ vec2 getAnimatedPos(vec2 basePos, float height, float noise){
     return vec2(newX, newY);
 }
 
-void getVerticesPositionsAndNormals(vec3 pos, float width, float height, float tilt, vec2 bend, vec3 color,
-    vec2 flowDirection,
-    out vec3 positions[NB_VERT_HIGH_LOD],
-    out vec3 normals[NB_VERT_HIGH_LOD],
-    out vec3 colors[NB_VERT_HIGH_LOD]
+#include "bladeSegments.glsl"
+
+// the blade's data shared by its vertices, computed once per blade
+struct BladeFrame{
+    vec3 center;
+    float height;
+    mat3 rotation;          // around the base, facing the camera
+    vec3 windOffset;        // displacement of the tip, scaled by the height of each vertex
+    mat4 viewProj;
+    vec3 tint;              // mixed with the colors in the wind comparison mode
+    float tintAmount;
+};
+
+// return the number of vertices of the blade
+int getVerticesPositionsAndNormals(vec3 pos, float width, float height, vec3 color,
+    vec2 P0, vec2 P1, vec2 P2,
+    out vec3 positions[MAX_NB_VERT],
+    out vec3 normals[MAX_NB_VERT],
+    out vec3 colors[MAX_NB_VERT]
     ){
-    int nbVert = tileLOD == HIGH_LOD ? NB_VERT_HIGH_LOD : NB_VERT_LOW_LOD;
-
-    float minWidth = width / 5.f;
-    float widthDelta = minWidth / nbVert;
-    float curWidth = width / 2.f;
-
-    // float noise = infinitePerlin(pos.xz);
-    float noise = windField(pos.xz, time, flowDirection);
-    float noiseColor = windField(pos.xz, time, flowDirection);
-
-    // vec2 deltaSubtle = vec2(0.1f*abs(noiseSubtle), 0.01f*noiseSubtle);
-
-    vec2 P0 = vec2(0.f);
-    vec2 P1 = bend;
-    vec2 P2 = vec2(tilt, height);
-    // vec2 P1 = bend + deltaSubtle;
-    // vec2 P2 = vec2(tilt, height) + deltaSubtle;
-    P1 = getAnimatedPos(P1, height, noise);
-    P2 = getAnimatedPos(P2, height, noise);
+    float nbSegments = getNbSegments(pos, height);
+    int nbVert = 2 * getNbRows(nbSegments) + 1;
 
     vec3 widthTangent = vec3(0.f, 0.f, 1.f);
+    // rotate the normals a bit
+    mat3 leftNormalRotation = getRotationMatrix(PI * (-0.3f));
+    mat3 rightNormalRotation = getRotationMatrix(PI * 0.3f);
 
     for(int i=0; i<nbVert-1; i+=2){
-        float t = i / (1.f * nbVert);
+        vec2 rowShape = getRowShape(i / 2, nbSegments);
+        float t = rowShape.x;
+        float curWidth = 0.5f * width * rowShape.y;
         vec2 bendAndTilt = quadraticBezierCurve(t, P0, P1, P2);
-        vec3 newPosLeft = pos + vec3(bendAndTilt.x, bendAndTilt.y, -curWidth);
-        vec3 newPosRight = pos + vec3(bendAndTilt.x, bendAndTilt.y, curWidth);
-        positions[i] = newPosLeft;
-        positions[i+1] = newPosRight;
-        // positions[i] = getAnimatedPos(newPosLeft, height, noise);
-        // positions[i+1] = getAnimatedPos(newPosRight, height, noise);
-        colors[i] = getColor(color, height, bendAndTilt.y);
-        colors[i+1] = getColor(color, height, bendAndTilt.y);
-        // colors[i] = noiseColor*vec3(1.f,1.f,1.f);
-        // colors[i+1] = noiseColor*vec3(1.f,1.f,1.f);
-        curWidth -= widthDelta;
+        positions[i] = pos + vec3(bendAndTilt.x, bendAndTilt.y, -curWidth);
+        positions[i+1] = pos + vec3(bendAndTilt.x, bendAndTilt.y, curWidth);
+        vec3 segmentColor = getColor(color, height, bendAndTilt.y);
+        colors[i] = segmentColor;
+        colors[i+1] = segmentColor;
 
         vec2 bezierDerivative = quadraticBezierCurveDerivative(t, P0, P1, P2);
         vec3 bezierNormal = normalize(vec3(bezierDerivative.x, bezierDerivative.y, 0.f));
         vec3 normal = cross(bezierNormal, widthTangent);
-        // rotate the normals a bit
-        // normals[i] = normal;
-        // normals[i+1] = normal;
-        normals[i] = normalize(getRotationMatrix(PI * (-0.3f)) * normal);
-        normals[i+1] = normalize(getRotationMatrix(PI * 0.3f) * normal);
+        normals[i] = normalize(leftNormalRotation * normal);
+        normals[i+1] = normalize(rightNormalRotation * normal);
     }
 
-    vec3 newPos = pos + vec3(P2, 0.f);
-    positions[nbVert-1] = newPos;
-    // positions[nbVert-1] = getAnimatedPos(newPos, height, noise);
+    positions[nbVert-1] = pos + vec3(P2, 0.f);
     vec2 bezierDerivative = quadraticBezierCurveDerivative(1.f, P0, P1, P2);
     vec3 bezierNormal = normalize(vec3(bezierDerivative.x, bezierDerivative.y, 0.f));
-    vec3 normal = cross(bezierNormal, widthTangent);
-    normals[nbVert-1] = normal;
+    normals[nbVert-1] = cross(bezierNormal, widthTangent);
     colors[nbVert-1] = TIP_COLOR;
-    // colors[nbVert-1] = noiseColor*vec3(1.f,1.f,1.f);
-}
-
-vec3 getModelPos(vec3 center, vec3 position, float rotation){
-    return getRotationMatrix(rotation) * (position - center) + center;
-}
 
-vec3 getModelPos(vec3 center, vec3 positions[NB_VERT_HIGH_LOD], int vertex, float rotation){
-    return getModelPos(center, positions[vertex], rotation);
+    return nbVert;
 }
 
-vec4 getWorldPos(vec3 center, vec3 position, float rotation, vec2 flowDirection, float height){
-    vec3 curPosition = getModelPos(center, position, rotation);
-    // test flow direction
-    float noise = windField(center.xz, time, flowDirection); // [-1, 1]
-    float factor = 0.5f * (position.y / height);
-    vec3 direction = vec3(flowDirection.x, 0.f, flowDirection.y);
-    curPosition += noise * factor * direction; 
-
-    vec4 worldPosition = proj * view * vec4(curPosition, 1.f);
-    return worldPosition;
-}
-
-vec4 getWorldPos(vec3 center, vec3 positions[NB_VERT_HIGH_LOD], int vertex, float rotation, vec2 flowDirection, float height){
-    return getWorldPos(center, positions[vertex], rotation, flowDirection, height);
-}
-
-vec3 getRotatedNormals(vec3 normal, float rotation){
-    return normalize(getRotationMatrix(rotation) * normal);
-}
+// the vertices alternate left and right up to the tip so each of them is emitted once
+void createStrip(BladeFrame blade, int nbVert,
+    vec3 positions[MAX_NB_VERT], 
+    vec3 normals[MAX_NB_VERT],
+    vec3 colors[MAX_NB_VERT]
+    ){
+    for(int i=0; i<nbVert; i++){
+        vec3 modelPos = blade.rotation * (positions[i] - blade.center) + blade.center;
+        vec3 worldPos = modelPos + (positions[i].y / blade.height) * blade.windOffset;
 
-void createTriangle(vec3 center, 
-    vec3 positions[NB_VERT_HIGH_LOD], 
-    vec3 normals[NB_VERT_HIGH_LOD], 
-    vec3 colors[NB_VERT_HIGH_LOD],
-    float height, float rotation, vec3 color, int indices[3], vec2 flowDirection){
-    int idx = 0;
-    for(int i=0; i<3; i++){
-        idx = indices[i];
-        vec3 modelPos = getModelPos(center, positions, idx, rotation);
-        vec4 worldPos = getWorldPos(center, positions, idx, rotation, flowDirection, height);
-        vec3 normal = getRotatedNormals(normals[idx], rotation);
-        geomFragCol = colors[idx];
-        geomFragNormal = normal;
+        geomFragCol = mix(colors[i], blade.tint, blade.tintAmount);
+        geomFragNormal = normalize(blade.rotation * normals[i]);
         geomFragPos = modelPos;
-        // geomFragLod = tileLOD == HIGH_LOD ? 1 : 0;
-        gl_Position = worldPos;
-        EmitVertex();    
+        gl_Position = blade.viewProj * vec4(worldPos, 1.f);
+        EmitVertex();
     }
     EndPrimitive();
 }
 
-void createTriangles(vec3 center, float rotation, vec3 color, float height,
-    vec2 flowDirection,
-    vec3 positions[NB_VERT_HIGH_LOD], 
-    vec3 normals[NB_VERT_HIGH_LOD],
-    vec3 colors[NB_VERT_HIGH_LOD]
-    ){
-    int nbQuads = tileLOD == HIGH_LOD ? NB_QUAD_HIGH_LOD : NB_QUAD_LOW_LOD;
-    int nbVert = tileLOD == HIGH_LOD ? NB_VERT_HIGH_LOD : NB_VERT_LOW_LOD;
-    int vertCounter = 0;
-    int indices[3];
-    // draw the rectangles
-    for(int i=0; i<nbQuads; i++){
-        // first triangle
-        indices[0] = vertCounter;
-        indices[1] = vertCounter+1;
-        indices[2] = vertCounter+2;
-        createTriangle(center, positions, normals, colors, height, rotation, color, indices, flowDirection);
-
-        // second triangle
-        indices[0] = vertCounter+2;
-        indices[1] = vertCounter+1;
-        indices[2] = vertCounter+3;
-        createTriangle(center, positions, normals, colors, height, rotation, color, indices, flowDirection);
-
-        vertCounter += 2;
-    }
-    // last triangle
-    indices[0] = nbVert-3;
-    indices[1] = nbVert-2;
-    indices[2] = nbVert-1;
-    createTriangle(center, positions, normals, colors, height, rotation, color, indices, flowDirection);
-}
-
 vec3 getAvgNormal(float tilt, float height){
     vec3 P0 = vec3(0.f);
     vec3 P1 = vec3(tilt, height, 0.f);
@@ -543,7 +289,7 @@ vec3 getAvgNormal(float tilt, float height){
 float getRotation(float tilt, float height){
     float rotation = vertexData[0]._Rotation;
     vec3 normal = getAvgNormal(tilt, height);
-    normal = (view*vec4(getRotatedNormals(normal, rotation), 1.f)).xyz;
+    normal = (view*vec4(normalize(getRotationMatrix(rotation) * normal), 1.f)).xyz;
 
     vec3 camDir = vec3(0.f, 0.f, -1.f);
     float dotProduct = dot(normalize(camDir), normalize(normal));
@@ -559,14 +305,32 @@ void main(){
     vec3 color = vertexData[0]._Color.xyz;
     float tilt = vertexData[0]._Tilt;
     vec2 bend = vertexData[0]._Bend;
-    float rotation = getRotation(tilt, height);
-
-    vec3 positions[NB_VERT_HIGH_LOD];
-    vec3 normals[NB_VERT_HIGH_LOD];
-    vec3 colors[NB_VERT_HIGH_LOD];
     vec2 flowDirection = normalize(vec2(1.0, 0.5));  // Adjust the main wind direction
 
-    getVerticesPositionsAndNormals(pos, width, height, tilt, bend, color, flowDirection, positions, normals, colors);
-    createTriangles(pos, rotation, color, height, flowDirection, positions, normals, colors);
+    // the wind only depends on the blade's base
+    float noise = getWind(pos.xz, flowDirection); // [-1, 1]
+
+    BladeFrame blade;
+    blade.center = pos;
+    blade.height = height;
+    blade.rotation = getRotationMatrix(getRotation(tilt, height));
+    blade.windOffset = 0.5f * noise * vec3(flowDirection.x, 0.f, flowDirection.y);
+    blade.viewProj = proj * view;
+    blade.tint = vec3(0.f);
+    blade.tintAmount = 0.f;
+#if WIND_MODE == WIND_MODE_COMPARE
+    blade.tint = WIND_ERROR_COLOR;
+    blade.tintAmount = getWindError(pos.xz, flowDirection);
+#endif
+
+    // animated control points of the blade's curve
+    vec2 P0 = vec2(0.f);
+    vec2 P1 = getAnimatedPos(bend, height, noise);
+    vec2 P2 = getAnimatedPos(vec2(tilt, height), height, noise);
 
-}
\ No newline at end of file
+    vec3 positions[MAX_NB_VERT];
+    vec3 normals[MAX_NB_VERT];
+    vec3 colors[MAX_NB_VERT];
+    int nbVert = getVerticesPositionsAndNormals(pos, width, height, color, P0, P1, P2, positions, normals, colors);
+    createStrip(blade, nbVert, positions, normals, colors);
+}
@@ -0,0 +1,266 @@
+#version 450 core
+#extension GL_ARB_shader_draw_parameters : require
+	
+// packed blade record, must match GrassBlade (grassBlade.hpp)
+struct Blade{
+    float posX;
+    float posZ;
+    uint heightWidth;       // half2(height, width)
+    uint tiltBendX;         // half2(tilt, bend.x)
+    uint bendYRotation;     // half(bend.y) | 16 bits angle << 16
+    uint clump;             // index in the clump table
+};
+
+layout(binding = 0, std430) readonly buffer blades{
+    Blade iBlade[];     // Grass blades
+};
+
+// parameters shared by the blades of a clump
+struct Clump{
+    vec4 color;
+};
+
+layout(binding = 1, std430) readonly buffer clumps{
+    Clump iClump[];     // Clumps of the cached tiles
+};
+
+struct DrawInfo{
+    uint startId;   // First blade of the tile in the buffers
+    uint tileId;
+    uint nbBlades;
+};
+
+layout(binding = 7, std430) readonly buffer drawInfos{
+    DrawInfo iDrawInfo[];
+};
+
+layout(binding = 13, std430) readonly buffer visibleBlades{
+    uint iVisibleBlade[];   // Blades kept by the compaction, packed from startId
+};
+
+// per frame data, must match FrameUniformsData (frameUniforms.hpp)
+layout(std140, binding = 0) uniform FrameUniformsBlock{
+    mat4 view;
+    mat4 proj;
+    vec3 camPos;
+    float time;
+    vec4 frustumPlanes[6];  // normal and distance to the origin
+};
+// number of segments of a blade per meter of height at 1 meter from the camera
+uniform float segmentScale;
+
+const int MAX_NB_SEGMENTS = 7;
+
+// wind of the blades, set by WindField::getDefines (windField.hpp)
+// 0: wind texture, 1: simplex noise, 2: wind texture tinted by its difference with the noise
+#ifndef WIND_MODE
+#define WIND_MODE 0
+#endif
+#ifndef WIND_EXTENT
+#define WIND_EXTENT 80.0
+#endif
+#define WIND_MODE_ANALYTIC 1
+#define WIND_MODE_COMPARE 2
+
+#if WIND_MODE != WIND_MODE_ANALYTIC
+// window of WIND_EXTENT meters around the camera, wrapped around its edges
+layout(binding = 4) uniform sampler2D windTexture;
+#endif
+
+const vec3 TIP_COLOR = vec3(0.5f, 0.5f, 0.1f);
+#include "bladeRotation.glsl"
+
+// same outputs as the geometry shader
+out vec3 geomFragCol;
+out vec3 geomFragNormal;
+out vec3 geomFragPos;
+
+#include "windNoise.glsl"
+
+// [-1, 1]
+float getWind(vec2 pos, vec2 flowDirection){
+#if WIND_MODE == WIND_MODE_ANALYTIC
+    return windField(pos, time, flowDirection);
+#else
+    return textureLod(windTexture, pos / WIND_EXTENT, 0.f).r;
+#endif
+}
+
+#if WIND_MODE == WIND_MODE_COMPARE
+const vec3 WIND_ERROR_COLOR = vec3(1.f, 0.f, 0.f);
+// difference between the texture and the noise shown at full color
+const float WIND_ERROR_RANGE = 0.05f;
+
+// tint of the blade by the difference between the texture and the noise, in [0, 1]
+float getWindError(vec2 pos, vec2 flowDirection){
+    float error = abs(getWind(pos, flowDirection) - windField(pos, time, flowDirection));
+    return clamp(error / WIND_ERROR_RANGE, 0.f, 1.f);
+}
+#endif
+
+
+mat3 getRotationMatrix(float rotation){
+    return mat3(cos(rotation), 0.f, sin(rotation),
+                0.f, 1.f, 0.f,
+                -sin(rotation), 0.f, cos(rotation));
+}
+
+
+vec2 quadraticBezierCurve(float t, vec2 P0, vec2 P1, vec2 P2){
+    return (1.f-t)*(1.f-t)*P0 + 2.f*(1.f-t)*t*P1 + t*t*P2;
+}
+
+vec2 quadraticBezierCurveDerivative(float t, vec2 P0, vec2 P1, vec2 P2){
+    return -2.f*(1.f-t)*P0 + 2.f*P1*(1.f-2.f*t) + 2.f*t*P2;
+}
+
+vec3 getColor(vec3 color, float maxHeight, float curHeight){
+    return mix(color, TIP_COLOR, (curHeight / maxHeight) * 0.8f);
+}
+
+vec2 getAnimatedPos(vec2 basePos, float height, float noise){
+    float theta = noise;
+
+    float phaseY = basePos.y / height;
+    float amplitudeY = 0.05f;
+    float frequencyY = 5.f * phaseY;
+
+    float yDelta = amplitudeY*sin(frequencyY*theta + phaseY);
+    // float yDelta = 0.f;
+    float newY = basePos.y + yDelta;
+
+    float phaseX = newY / height;
+    float amplitudeX = 0.1f;
+    float frequencyX = 2.f * phaseX;
+
+    float xDelta = amplitudeX*sin(frequencyX*theta + phaseX);
+    // float xDelta = 0.f;
+    float newX = basePos.x + xDelta;
+
+    return vec2(newX, newY);
+}
+
+vec3 getAvgNormal(float tilt, float height){
+    vec3 P0 = vec3(0.f);
+    vec3 P1 = vec3(tilt, height, 0.f);
+    vec3 widthTangent = vec3(0.f, 0.f, 1.f);
+    vec3 heightTangent = normalize(P1-P0);
+    return cross(heightTangent, widthTangent);
+}
+
+vec3 getRotatedNormals(vec3 normal, float rotation){
+    return normalize(getRotationMatrix(rotation) * normal);
+}
+
+float getRotation(float rotation, float tilt, float height){
+    vec3 normal = getAvgNormal(tilt, height);
+    normal = (view*vec4(getRotatedNormals(normal, rotation), 1.f)).xyz;
+
+    vec3 camDir = vec3(0.f, 0.f, -1.f);
+    float dotProduct = dot(normalize(camDir), normalize(normal));
+    rotation += acos(dotProduct) / 3.f;
+
+    return rotation;
+}
+
+vec4 getBladePosition(Blade blade){
+    return vec4(blade.posX, 0.f, blade.posZ, 1.f);
+}
+
+float getBladeHeight(Blade blade){
+    return unpackHalf2x16(blade.heightWidth).x;
+}
+
+float getBladeWidth(Blade blade){
+    return unpackHalf2x16(blade.heightWidth).y;
+}
+
+float getBladeTilt(Blade blade){
+    return unpackHalf2x16(blade.tiltBendX).x;
+}
+
+vec2 getBladeBend(Blade blade){
+    return vec2(unpackHalf2x16(blade.tiltBendX).y, unpackHalf2x16(blade.bendYRotation).x);
+}
+
+float getBladeRotation(Blade blade){
+    return unpackRotation(blade.bendYRotation);
+}
+
+vec4 getBladeColor(Blade blade){
+    return iClump[blade.clump].color;
+}
+
+#include "bladeSegments.glsl"
+
+vec3 getBezierNormal(float t, vec2 P0, vec2 P1, vec2 P2){
+    vec3 widthTangent = vec3(0.f, 0.f, 1.f);
+    vec2 bezierDerivative = quadraticBezierCurveDerivative(t, P0, P1, P2);
+    vec3 bezierNormal = normalize(vec3(bezierDerivative.x, bezierDerivative.y, 0.f));
+    return cross(bezierNormal, widthTangent);
+}
+
+
+// Each instance is a blade drawn as a triangle strip,
+// the vertices are ordered left, right, left, right, ..., tip
+void main() {
+    uint startId = iDrawInfo[gl_DrawIDARB].startId;
+    int id = int(iVisibleBlade[startId + gl_InstanceID]);
+
+    Blade blade = iBlade[id];
+    vec3 pos = getBladePosition(blade).xyz;
+    float height = getBladeHeight(blade);
+    float width = getBladeWidth(blade);
+    vec3 color = getBladeColor(blade).xyz;
+    float tilt = getBladeTilt(blade);
+    vec2 bend = getBladeBend(blade);
+    float rotation = getRotation(getBladeRotation(blade), tilt, height);
+    vec2 flowDirection = normalize(vec2(1.0, 0.5));  // Adjust the main wind direction
+
+    // the vertices past the tip collapse on it
+    float nbSegments = getNbSegments(pos, height);
+    int nbVert = 2 * getNbRows(nbSegments) + 1;
+    int vertex = min(gl_VertexID, nbVert-1);
+
+    float noise = getWind(pos.xz, flowDirection); // [-1, 1]
+    vec2 P0 = vec2(0.f);
+    vec2 P1 = getAnimatedPos(bend, height, noise);
+    vec2 P2 = getAnimatedPos(vec2(tilt, height), height, noise);
+
+    vec3 position;
+    vec3 normal;
+    vec3 vertexColor;
+    if(vertex == nbVert-1){
+        position = pos + vec3(P2, 0.f);
+        normal = getBezierNormal(1.f, P0, P1, P2);
+        vertexColor = TIP_COLOR;
+    } else {
+        int side = vertex % 2; // 0 left, 1 right
+        int row = vertex - side;
+        vec2 rowShape = getRowShape(row / 2, nbSegments);
+        float t = rowShape.x;
+        float curWidth = 0.5f * width * rowShape.y;
+
+        vec2 bendAndTilt = quadraticBezierCurve(t, P0, P1, P2);
+        position = pos + vec3(bendAndTilt.x, bendAndTilt.y, side == 0 ? -curWidth : curWidth);
+        vertexColor = getColor(color, height, bendAndTilt.y);
+        // rotate the normals a bit
+        float normalRotation = side == 0 ? PI * (-0.3f) : PI * 0.3f;
+        normal = normalize(getRotationMatrix(normalRotation) * getBezierNormal(t, P0, P1, P2));
+    }
+
+    // one rotation for the position and the normal
+    mat3 bladeRotation = getRotationMatrix(rotation);
+    vec3 modelPos = bladeRotation * (position - pos) + pos;
+    float factor = 0.5f * (position.y / height);
+    vec3 direction = vec3(flowDirection.x, 0.f, flowDirection.y);
+    vec3 worldPos = modelPos + noise * factor * direction;
+
+    geomFragCol = vertexColor;
+#if WIND_MODE == WIND_MODE_COMPARE
+    geomFragCol = mix(vertexColor, WIND_ERROR_COLOR, getWindError(pos.xz, flowDirection));
+#endif
+    geomFragNormal = normalize(bladeRotation * normal);
+    geomFragPos = modelPos;
+    gl_Position = proj * view * vec4(worldPos, 1.f);
+}
\ No newline at end of file
@@ -1,36 +1,46 @@
 #version 450 core
+#extension GL_ARB_shader_draw_parameters : require
 	
-layout(binding = 0, std430) readonly buffer positions{
-    vec4 iPosition[];  // Grass blade position
+// packed blade record, must match GrassBlade (grassBlade.hpp)
+struct Blade{
+    float posX;
+    float posZ;
+    uint heightWidth;       // half2(height, width)
+    uint tiltBendX;         // half2(tilt, bend.x)
+    uint bendYRotation;     // half(bend.y) | 16 bits angle << 16
+    uint clump;             // index in the clump table
 };
 
-layout(binding = 1, std430) readonly buffer heights{
-    float iHeight[];   // Grass blade height
+layout(binding = 0, std430) readonly buffer blades{
+    Blade iBlade[];     // Grass blades
 };
 
-layout(binding = 2, std430) readonly buffer widths{
-    float iWidth[];    // Grass blade width
+// parameters shared by the blades of a clump
+struct Clump{
+    vec4 color;
 };
 
-layout(binding = 3, std430) readonly buffer colors{
-    vec4 iColor[];  // Grass blade color
+layout(binding = 1, std430) readonly buffer clumps{
+    Clump iClump[];     // Clumps of the cached tiles
 };
 
-layout(binding = 4, std430) readonly buffer rotations{
-    float iRotation[];  // Grass blade rotation
+struct DrawInfo{
+    uint startId;   // First blade of the tile in the buffers
+    uint tileId;
+    uint nbBlades;
 };
 
-layout(binding = 5, std430) readonly buffer tilts{
-    float iTilt[];    // Grass blade tilt
+layout(binding = 7, std430) readonly buffer drawInfos{
+    DrawInfo iDrawInfo[];
 };
 
-layout(binding = 6, std430) readonly buffer bends{
-    vec2 iBend[];    // Grass blade bend
+layout(binding = 13, std430) readonly buffer visibleBlades{
+    uint iVisibleBlade[];   // Blades kept by the compaction, packed from startId
 };
 
 // uniform int parallelId;
 // uniform int nbBladesPerTile;
-uniform int startId;
+// uniform int startId;
 
 out VertexData{
     vec4 _Position;
@@ -42,16 +52,48 @@ out VertexData{
     vec2 _Bend;
 } vertexData;
 
+#include "bladeRotation.glsl"
+
+vec4 getBladePosition(Blade blade){
+    return vec4(blade.posX, 0.f, blade.posZ, 1.f);
+}
+
+float getBladeHeight(Blade blade){
+    return unpackHalf2x16(blade.heightWidth).x;
+}
+
+float getBladeWidth(Blade blade){
+    return unpackHalf2x16(blade.heightWidth).y;
+}
+
+float getBladeTilt(Blade blade){
+    return unpackHalf2x16(blade.tiltBendX).x;
+}
+
+vec2 getBladeBend(Blade blade){
+    return vec2(unpackHalf2x16(blade.tiltBendX).y, unpackHalf2x16(blade.bendYRotation).x);
+}
+
+float getBladeRotation(Blade blade){
+    return unpackRotation(blade.bendYRotation);
+}
+
+vec4 getBladeColor(Blade blade){
+    return iClump[blade.clump].color;
+}
+
 
 void main() {
-    int id = gl_VertexID;
-    id += startId;
-
-    vertexData._Position = iPosition[id];
-    vertexData._Height = iHeight[id];
-    vertexData._Width = iWidth[id];
-    vertexData._Color = iColor[id];
-    vertexData._Rotation = iRotation[id];
-    vertexData._Tilt = iTilt[id];
-    vertexData._Bend = iBend[id];
+    uint startId = iDrawInfo[gl_DrawIDARB].startId;
+    int id = int(iVisibleBlade[startId + gl_VertexID]);
+
+    Blade blade = iBlade[id];
+
+    vertexData._Position = getBladePosition(blade);
+    vertexData._Height = getBladeHeight(blade);
+    vertexData._Width = getBladeWidth(blade);
+    vertexData._Color = getBladeColor(blade);
+    vertexData._Rotation = getBladeRotation(blade);
+    vertexData._Tilt = getBladeTilt(blade);
+    vertexData._Bend = getBladeBend(blade);
 }
\ No newline at end of file
@@ -0,0 +1,42 @@
+#version 450 core
+
+// Buffers and layouts
+
+// one invocation per texel of the wind texture
+layout (local_size_x = 16, local_size_y = 16, local_size_z = 1) in;
+
+// texels of a side of the texture, a power of two, and meters it covers, set by WindField::getDefines (windField.hpp)
+#ifndef WIND_SIZE
+#define WIND_SIZE 256
+#endif
+#ifndef WIND_EXTENT
+#define WIND_EXTENT 80.0
+#endif
+
+layout(binding = 0, r16f) writeonly uniform image2D windImage;
+
+// per frame data, must match FrameUniformsData (frameUniforms.hpp)
+layout(std140, binding = 0) uniform FrameUniformsBlock{
+    mat4 view;
+    mat4 proj;
+    vec3 camPos;
+    float time;
+    vec4 frustumPlanes[6];  // normal and distance to the origin
+};
+
+#include "windNoise.glsl"
+
+void main() {
+    ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+    if(any(greaterThanEqual(texel, ivec2(WIND_SIZE)))) return;
+
+    // the texture is a window of WIND_EXTENT meters around the camera, wrapped around its edges:
+    // the world texel k is stored at k % WIND_SIZE so the blades sample it at pos / WIND_EXTENT with repeat
+    const float texelSize = WIND_EXTENT / float(WIND_SIZE);
+    ivec2 firstTexel = ivec2(floor(camPos.xz / texelSize)) - ivec2(WIND_SIZE / 2);
+    ivec2 worldTexel = firstTexel + ((texel - firstTexel) & ivec2(WIND_SIZE - 1));
+    vec2 pos = (vec2(worldTexel) + 0.5f) * texelSize;
+
+    vec2 flowDirection = normalize(vec2(1.0, 0.5));  // must match the blades' wind direction
+    imageStore(windImage, texel, vec4(windField(pos, time, flowDirection)));
+}
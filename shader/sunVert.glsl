@@ -2,8 +2,14 @@
 
 layout (location = 0) in vec3 vPosition;
 
-uniform mat4 view;
-uniform mat4 proj;
+// per frame data, must match FrameUniformsData (frameUniforms.hpp)
+layout(std140, binding = 0) uniform FrameUniformsBlock{
+    mat4 view;
+    mat4 proj;
+    vec3 camPos;
+    float time;
+    vec4 frustumPlanes[6];  // normal and distance to the origin
+};
 
 void main(){
     gl_Position = proj * view * vec4(vPosition, 1.f); 
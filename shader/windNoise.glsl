@@ -0,0 +1,100 @@
+// noise of the wind, included by the wind pass (grassWind.glsl) and by the blades for the analytic and compare modes
+
+// ************************************************ //
+// GLSL Simplex Noise
+// //
+// Description : Array and textureless GLSL 2D/3D/4D simplex
+// noise functions.
+// Author : Ian McEwan, Ashima Arts.
+// Maintainer : ijm
+// Lastmod : 20110822 (ijm)
+// License : Copyright (C) 2011 Ashima Arts. All rights reserved.
+// Distributed under the MIT License. See LICENSE file.
+// https://github.com/ashima/webgl-noise
+//
+// See: https://www.shadertoy.com/view/Mds3Wr
+// ************************************************ //
+float smooth_snoise(in vec2 v);
+float snoise(in vec2 v, int octaves) {
+	float res = 0.0;
+	float scale = 1.0;
+	for(int i=0; i<8; i++) {
+		if(i >= octaves) break;
+		res += smooth_snoise(v) * scale;
+		v *= vec2(2.0, 2.0);
+		scale *= 0.5;
+	}
+	return res;
+}
+
+vec3 mod289(in vec3 x) {
+    return x - floor(x * (1.0 / 289.0)) * 289.0;
+}
+
+vec2 mod289(in vec2 x) {
+    return x - floor(x * (1.0 / 289.0)) * 289.0;
+}
+
+vec3 permute(in vec3 x) {
+    return mod289(((x*34.0)+1.0)*x);
+}
+
+float smooth_snoise(in vec2 v){
+    const vec4 C = vec4(0.211324865405187,
+                        0.366025403784439, 
+                        -0.577350269189626,
+                        0.024390243902439);
+    // First corner
+    vec2 i = floor(v + dot(v, C.yy) );
+    vec2 x0 = v - i + dot(i, C.xx);
+
+    // Other corners
+    vec2 i1;
+    i1 = (x0.x > x0.y) ? vec2(1.0, 0.0) : vec2(0.0, 1.0);
+    vec4 x12 = x0.xyxy + C.xxzz;
+    x12.xy -= i1;
+
+    // Permutations
+    i = mod289(i);
+    vec3 p = permute( permute( i.y + vec3(0.0, i1.y, 1.0 ))
+    + i.x + vec3(0.0, i1.x, 1.0 ));
+
+    vec3 m = max(0.5 - vec3(dot(x0,x0), dot(x12.xy,x12.xy), dot(x12.zw,x12.zw)), 0.0);
+    m = m*m ;
+    m = m*m ;
+
+    vec3 x = 2.0 * fract(p * C.www) - 1.0;
+    vec3 h = abs(x) - 0.5;
+    vec3 ox = floor(x + 0.5);
+    vec3 a0 = x - ox;
+
+    m *= 1.79284291400159 - 0.85373472095314 * ( a0*a0 + h*h );
+
+    vec3 g;
+    g.x = a0.x * x0.x + h.x * x0.y;
+    g.yz = a0.yz * x12.xz + h.yz * x12.yw;
+    return 130.0 * dot(m, g);
+}
+
+// ************************************************ //
+
+
+float windField(vec2 uv, float dt, vec2 flowDirection) {
+    const float speed = 0.8f;  // Adjust the speed of the wind
+    const int octaves = 5;    // Adjust the number of octaves
+    const float persistence = .5f;  // Adjust the persistence of the noise
+    float scale = 1.f;  // Adjust the scale of the noise
+
+    vec2 movingUV = uv + flowDirection * dt * speed;
+    // generate wind field using multiple octaves of Simplex noise
+    float windFieldStrength = 0.f;
+    float amplitude = 1.f;
+
+    for (int i = 0; i < octaves; i++) {
+        windFieldStrength += amplitude * snoise(movingUV * scale, i);
+        scale /= 4.0f;  // Adjust the scale for each octave
+        amplitude *= persistence;  // Adjust the amplitude for each octave
+    }
+
+    return windFieldStrength; // [-1, 1]
+}
@@ -1,25 +1,43 @@
 #include "application.hpp"
+#include "benchReport.hpp"
 #include "camera.hpp"
 #include "errorHandler.hpp"
+#include "glDebug.hpp"
 #include "grass.hpp"
 #include "gui.hpp"
+#include "programCache.hpp"
+#include "shaderRegistry.hpp"
 #include "shaders.hpp"
 
 #include <GLFW/glfw3.h>
+#include <algorithm>
 #include <cstdlib>
 #include <glm/fwd.hpp>
 #include <iostream>
 
+GLuint Application::_Width = 1280;
+GLuint Application::_Height = 720;
+
 void Application::initGLAD(){
     if(!gladLoadGL((GLADloadfunc)glfwGetProcAddress)){
         fprintf(stderr, "Failed to init GLAD!\n");
         ErrorHandler::handle(ErrorCodes::GLAD_ERROR);
         exit(EXIT_FAILURE);
     }
+    // the debug output replaces the error flag checks
+    if(_Options._GLDebugSeverity != GL_NONE){
+        GLDebug::enable(_Options._GLDebugSeverity, _Options._GLDebugSynchronous);
+    }
 }
 
 void Application::initShaders(){
-    _Shaders = ShadersPointer( new Shaders("shader/grassVert.glsl", "shader/grassFrag.glsl", "shader/grassGeom.glsl"));
+    // the blades sample the wind texture or compute the noise
+    const std::string defines = WindField::getDefines(_Options._Wind);
+    if(_Options._Pipeline == GRASS_PIPELINE_VERTEX_PULLING){
+        _Shaders = ShadersPointer( new Shaders("shader/grassPullVert.glsl", "shader/grassFrag.glsl", "", defines));
+        return;
+    }
+    _Shaders = ShadersPointer( new Shaders("shader/grassVert.glsl", "shader/grassFrag.glsl", "shader/grassGeom.glsl", defines));
 }
 
 
@@ -30,6 +48,13 @@ void Application::initGLFW() {
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
     //glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
     glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+    if(_Options._GLDebugSeverity != GL_NONE){
+        glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
+    }
+    // the headless mode only needs the context, the window is never shown
+    if(_Options._Headless){
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    }
     
     _Window = glfwCreateWindow(_Width, _Height, "grass renderer", NULL, NULL);
     if(!_Window){
@@ -37,6 +62,10 @@ void Application::initGLFW() {
         ErrorHandler::handle(ErrorCodes::GLFW_ERROR);
         exit(EXIT_FAILURE);
     }
+    if(_Options._Headless){
+        glfwMakeContextCurrent(_Window);
+        return;
+    }
     // center window
     const GLFWvidmode* mode = glfwGetVideoMode(glfwGetPrimaryMonitor());
     int screenWidth = mode->width;
@@ -54,18 +83,41 @@ void Application::initGLFW() {
     glfwSetWindowUserPointer(_Window, this);
 }
 
+void Application::initOffscreen(){
+    glCreateRenderbuffers(1, &_OutputColor);
+    glNamedRenderbufferStorage(_OutputColor, GL_RGBA8, _Width, _Height);
+    glCreateRenderbuffers(1, &_OutputDepth);
+    glNamedRenderbufferStorage(_OutputDepth, GL_DEPTH_COMPONENT24, _Width, _Height);
+
+    glCreateFramebuffers(1, &_OutputFramebuffer);
+    glNamedFramebufferRenderbuffer(_OutputFramebuffer, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, _OutputColor);
+    glNamedFramebufferRenderbuffer(_OutputFramebuffer, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, _OutputDepth);
+    if(glCheckNamedFramebufferStatus(_OutputFramebuffer, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE){
+        fprintf(stderr, "Failed to init the offscreen framebuffer!\n");
+        ErrorHandler::handle(ErrorCodes::GL_ERROR);
+    }
+    glViewport(0, 0, _Width, _Height);
+}
+
 void Application::update(){
     updateDt();
-    _Grass->update(_DeltaTime, _Camera->getPosition());
+    // the simulation moves by fixed steps, whatever the frame rate
+    _Clock.addFrameTime(_DeltaTime);
+    // the animations only read the clock's time in the shaders, there is no state to update per step
+    while(_Clock.step()){}
 }
 
 void Application::render(const glm::mat4& view, const glm::mat4& proj){
+    glBindFramebuffer(GL_FRAMEBUFFER, _OutputFramebuffer);
     glClearColor(0.383f, 0.632f, 0.800f, 1.0f);
     // glClearColor(0.f, 0.f, 0.1f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    _FrameUniforms->update(view, proj, _Camera->getPosition(), _Clock.getInterpolatedTime(), _Camera->createFrustrum());
     _Grass->render(_Shaders.get(), _Camera, view, proj);
-    _Axis->render(view, proj);
-    _Sun->render(view, proj);
+    _Axis->render();
+    _Sun->render();
+    // the errors reported by the driver's threads during the frame
+    GLDebug::checkErrors();
 }
 
 void Application::handleCameraInput(){
@@ -152,36 +204,112 @@ void Application::handleInput(){
     }
 
 
+    handleClockInput();
     handleWireFrameInput();
     handleCameraInput();
 }
 
 void Application::init(){
+    auto start = std::chrono::high_resolution_clock::now();
     initGLFW();
     initGLAD();
+    if(_Options._Headless){
+        initOffscreen();
+    }
+    ProgramCache::setEnabled(!_Options._ShaderCacheDirectory.empty());
+    ProgramCache::setDirectory(_Options._ShaderCacheDirectory);
     initShaders();
+    _FrameUniforms = new FrameUniforms();
     _Axis = new Axis();
-    _Grass = new Grass();
+    _Grass = new Grass(_Options._Generation);
+    _Grass->setPipeline(_Options._Pipeline);
+    _Grass->setCulling(_Options._Culling);
+    _Grass->setWindMode(_Options._Wind);
+    _Grass->setBudget(_Options._TargetGpuTime, _Options._TriangleBudget);
+    _Grass->setOutputFramebuffer(_OutputFramebuffer);
     _Camera = new Camera(_Grass->getCenter(), (float)_Width / (float)_Height);
     initLights();
 
     glEnable(GL_DEPTH_TEST);
-    GLenum error = glGetError();
-    if (error != GL_NO_ERROR) {
-        fprintf(stderr, "Failed to enable z-buffer: %d\n", error);
-        ErrorHandler::handle(ErrorCodes::GL_ERROR);
-    }
+    ErrorHandler::checkGLError("Failed to enable z-buffer!");
     glDisable(GL_CULL_FACE);
-    error = glGetError();
-    if (error != GL_NO_ERROR) {
-        fprintf(stderr, "Failed to disable backface culling : %d\n", error);
-        ErrorHandler::handle(ErrorCodes::GL_ERROR);
+    ErrorHandler::checkGLError("Failed to disable backface culling!");
+
+    if(!_Options._Headless){
+        initGUI();
     }
 
-    initGUI();
+    // a warm start loads every program from the cache
+    auto end = std::chrono::high_resolution_clock::now();
+    GLuint nbCompiled = ProgramCache::getNbCompiled();
+    fprintf(stdout, "%s start in %.1f ms: %u programs loaded from the cache, %u compiled\n",
+        nbCompiled == 0 ? "Warm" : "Cold",
+        std::chrono::duration<double, std::milli>(end - start).count(),
+        ProgramCache::getNbLoaded(), nbCompiled
+    );
+}
+
+void Application::runHeadless(){
+    const float timestep = _Options._FixedTimestep;
+    const GLuint nbFrames = _Options._NbFrames;
+    CameraPath path;
+    if(_Options._CameraPath.empty() || !path.load(_Options._CameraPath)){
+        path = CameraPath::createOrbit(_Grass->getCenter(), 20.f, 6.f, nbFrames * timestep);
+    }
+
+    // the frames are a fixed step apart so every run renders the same images
+    BenchReport report;
+    GpuProfiler& profiler = _Grass->getProfiler();
+    profiler.setKeepHistory(true);
+    auto start = std::chrono::high_resolution_clock::now();
+    for(GLuint i=0; i<nbFrames; i++){
+        auto frameStart = std::chrono::high_resolution_clock::now();
+        BenchFrame& frame = report.addFrame();
+        frame._Time = i * timestep;
+        path.apply(frame._Time, *_Camera);
+        update();
+
+        _Shaders->use();
+        render(_Camera->getView(), _Camera->getPerspective());
+        auto submitEnd = std::chrono::high_resolution_clock::now();
+        // wait for the GPU so the frame time isn't only the submission
+        glFinish();
+        auto frameEnd = std::chrono::high_resolution_clock::now();
+        frame._CpuTime = std::chrono::duration<float, std::milli>(submitEnd - frameStart).count();
+        frame._FrameTime = std::chrono::duration<float, std::milli>(frameEnd - frameStart).count();
+
+        // the copy of the frame is ready once the GPU is done
+        _Grass->readCounters();
+        frame._NbGeneratedBlades = _Grass->getNbGeneratedBlades();
+        frame._NbDrawnBlades = _Grass->getNbVisibleBlades();
+        frame._NbTriangles = _Grass->getNbTriangles();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    report.setWallTime(std::chrono::duration<float>(end - start).count());
+
+    profiler.flush();
+    report.setGpuTimes(profiler.getHistory());
+    profiler.setKeepHistory(false);
+    report.print(_Options);
+    if(!_Options._BenchOutput.empty()){
+        report.writeJSON(_Options._BenchOutput, _Options);
+    }
 }
 
 void Application::run(){
+    if(_Options._VerifyGeneration){
+        bool isValid = _Grass->verifyGeneration();
+        GLDebug::checkErrors();
+        if(!isValid){
+            fprintf(stderr, "The CPU generation doesn't match the compute shader!\n");
+            ErrorHandler::handle(ErrorCodes::BAD_VALUE);
+        }
+        return;
+    }
+    if(_Options._Headless){
+        runHeadless();
+        return;
+    }
 
     while(!glfwWindowShouldClose(_Window)){
         handleInput();
@@ -201,7 +329,13 @@ void Application::run(){
 }
 
 void Application::quit(){
-    cleanIMGUI();
+    if(!_Options._Headless){
+        cleanIMGUI();
+    }
+    glDeleteFramebuffers(1, &_OutputFramebuffer);
+    glDeleteRenderbuffers(1, &_OutputColor);
+    glDeleteRenderbuffers(1, &_OutputDepth);
+    ShaderRegistry::clear();
     glfwDestroyWindow(_Window);
     glfwTerminate();
 }
\ No newline at end of file
@@ -2,7 +2,9 @@
 
 #include "axis.hpp"
 #include "camera.hpp"
+#include "cameraPath.hpp"
 #include "errorHandler.hpp"
+#include "frameUniforms.hpp"
 #include "imgui.h"
 #include "imgui_impl_glfw.h"
 #include "imgui_impl_opengl3.h"
@@ -11,7 +13,10 @@
 #include "light.hpp"
 #include "sun.hpp"
 #include "gui.hpp"
+#include "options.hpp"
+#include "simulationClock.hpp"
 
+#include <cfloat>
 #include <chrono>
 #include <cmath>
 #include <glad/gl.h>
@@ -30,19 +35,32 @@ enum MouseMode{
 
 class Application{
     public:
-        static const GLuint _Width = 1280;
-        static const GLuint _Height = 720;
+        // resolution of the window or of the offscreen framebuffer, set from the options
+        static GLuint _Width;
+        static GLuint _Height;
     private:
+        ApplicationOptions _Options;
         GLFWwindow* _Window = nullptr;
+        // framebuffer of the headless mode, 0 renders to the window
+        GLuint _OutputFramebuffer = 0;
+        GLuint _OutputColor = 0;
+        GLuint _OutputDepth = 0;
         ShadersPointer _Shaders = nullptr;
 
         Camera* _Camera = nullptr;
         Grass* _Grass = nullptr;
         Axis* _Axis = nullptr;
+        // view, projection, camera and time shared by every program
+        FrameUniforms* _FrameUniforms = nullptr;
+
+        // time of the animations, fed with the frame times
+        SimulationClock _Clock;
 
         float _CurrentFrameTime = 0.f;
         float _LastFrameTime = 0.f;
         float _DeltaTime = 0.f;
+        // frames rendered with the fixed step
+        GLuint _FixedFrameIndex = 0;
         float _TargetTime = 1.f / 60.f;
         GLuint _MinFPS = 0;
         GLuint _MaxFPS = 0;
@@ -64,6 +82,7 @@ class Application{
         ImGuiIO* _ImGuiIo = nullptr;
         bool _ImGuiShowAnalytics = true;
         bool _ImGuiShowHelp = true;
+        const std::string _ProfileCSVPath = "gpuProfile.csv";
 
         bool _isPressedG = false;
         bool _isPressedH = false;
@@ -71,6 +90,11 @@ class Application{
         MouseMode _MouseMode = MOUSE_MODE_CAMERA;
 
         bool _isPressedV = false;
+        bool _isPressedP = false;
+        bool _isPressedR = false;
+        bool _isPressedT = false;
+        bool _isPressedMinus = false;
+        bool _isPressedEqual = false;
         bool _SaveFrame = false;
         int _SaveFrameCount = 0;
         int _SaveVideoCount = 0;
@@ -81,12 +105,21 @@ class Application{
         void initGLFW();
         void initGLAD();
         void initShaders();
+        void initOffscreen();
+        void runHeadless();
         void handleInput();
         void handleCameraInput();
 
         void updateDt(){
-            _CurrentFrameTime = static_cast<float>(glfwGetTime());
-            _DeltaTime = _CurrentFrameTime - _LastFrameTime;
+            // a fixed step makes the runs reproducible, its time is computed from the frame index so it doesn't drift
+            if(_Options._FixedTimestep > 0.f){
+                _FixedFrameIndex++;
+                _CurrentFrameTime = static_cast<float>(_FixedFrameIndex * static_cast<double>(_Options._FixedTimestep));
+                _DeltaTime = _Options._FixedTimestep;
+            } else {
+                _CurrentFrameTime = static_cast<float>(glfwGetTime());
+                _DeltaTime = _CurrentFrameTime - _LastFrameTime;
+            }
             _LastFrameTime = _CurrentFrameTime;
             // update fps for analytics
             _NbFrames++;
@@ -117,6 +150,39 @@ class Application{
             glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
         }
 
+        /**
+         * Check if a key was pressed since the last frame
+         * @param key The key
+         * @param isPressed The state of the key, updated
+        */
+        bool isKeyPressedOnce(int key, bool& isPressed){
+            bool wasPressed = isPressed;
+            isPressed = glfwGetKey(_Window, key) == GLFW_PRESS;
+            return isPressed && !wasPressed;
+        }
+
+        void handleClockInput(){
+            if(isKeyPressedOnce(GLFW_KEY_P, _isPressedP)){
+                _Clock.setPaused(!_Clock.getIsPaused());
+            }
+            if(isKeyPressedOnce(GLFW_KEY_MINUS, _isPressedMinus)){
+                _Clock.setScale(std::max(1.f / 16.f, 0.5f * _Clock.getScale()));
+            }
+            if(isKeyPressedOnce(GLFW_KEY_EQUAL, _isPressedEqual)){
+                _Clock.setScale(std::min(16.f, 2.f * _Clock.getScale()));
+            }
+            if(isKeyPressedOnce(GLFW_KEY_R, _isPressedR)){
+                if(_Clock.getIsRecording()){
+                    _Clock.stopRecording();
+                } else {
+                    _Clock.startRecording();
+                }
+            }
+            if(isKeyPressedOnce(GLFW_KEY_T, _isPressedT)){
+                _Clock.replay();
+            }
+        }
+
         void handleWireFrameInput(){
             if(glfwGetKey(_Window, GLFW_KEY_F) == GLFW_PRESS){
                 setWireframeMode();
@@ -158,6 +224,36 @@ class Application{
             _ImGuiIo->FontGlobalScale = 1.5f;
         }
 
+        /**
+         * Show the rolling GPU times of the grass passes under the analytics
+        */
+        void renderProfilerGUI(){
+            const GpuProfiler& profiler = _Grass->getProfiler();
+            ImVec2 size{300, 330};
+            ImVec2 pos{_Width - 170 - size.x, 0};
+            ImGui::SetNextWindowPos(pos);
+            ImGui::Begin("GPU Profiler", &_ImGuiShowAnalytics);
+            ImGui::SetWindowSize(size);
+            for(int pass=0; pass<GPU_PASS_COUNT; pass++){
+                GpuPass gpuPass = GpuPass(pass);
+                const std::vector<float>& samples = profiler.getSamples(gpuPass);
+                ImGui::Text("%s: p50 %.2f p95 %.2f p99 %.2f", 
+                    GpuProfiler::getPassName(gpuPass),
+                    profiler.getP50(gpuPass),
+                    profiler.getP95(gpuPass),
+                    profiler.getP99(gpuPass));
+                ImGui::PushID(pass);
+                ImGui::PlotHistogram("", samples.data(), profiler.getNbSamples(), profiler.getSamplesOffset(), 
+                    nullptr, 0.f, FLT_MAX, ImVec2(size.x - 20, 25));
+                ImGui::PopID();
+            }
+            ImGui::Text("Dropped frames: %u", profiler.getNbDroppedFrames());
+            if(ImGui::Button("Export CSV")){
+                profiler.exportCSV(_ProfileCSVPath);
+            }
+            ImGui::End();
+        }
+
         void renderGUI(){
             // Start the Dear ImGui frame
             ImGui_ImplOpenGL3_NewFrame();
@@ -166,22 +262,37 @@ class Application{
 
             // analytics
             if(_ImGuiShowAnalytics){
-                ImVec2 size{170, 210};
+                ImVec2 size{170, 470};
                 ImVec2 pos{_Width - size.x, 0};
                 ImGui::SetNextWindowPos(pos);
                 ImGui::Begin("Analytics", &_ImGuiShowAnalytics);
                 ImGui::SetWindowSize(size);
                 ImGui::Text("FPS:\n  Avg: %d\n  Min: %d\n  Max: %d", _AvgFPS, _MinFPS, _MaxFPS);
                 ImGui::Text("MS:\n  Avg: %.1f\n  Min: %.1f\n  Max: %.1f", 
-                    1000.f * _MinDuration, 
                     1000.f * _Duration / _NbFrames, 
+                    1000.f * _MinDuration, 
                     1000.f * _MaxDuration);
+                const BladeCache& cache = _Grass->getBladeCache();
+                ImGui::Text("Cache:\n  Hits: %u\n  Misses: %u\n  Skipped: %u\n  Dispatches: %u\n  Tiles: %u/%u", 
+                    cache.getFrameHits(), 
+                    cache.getFrameMisses(), 
+                    cache.getFrameSkipped(), 
+                    cache.getTotalMisses(), 
+                    cache.getNbCachedTiles(), 
+                    cache.getNbSlots());
+                ImGui::Text("Blades:\n  Triangles: %u\n  Px/segment: %.1f", 
+                    _Grass->getNbTriangles(), 
+                    _Grass->getPixelsPerSegment());
+                ImGui::Text("Budget:\n  GPU: %.2f ms\n  Quality: %.2f", 
+                    _Grass->getGpuTime(), 
+                    _Grass->getBudget().getQuality());
                 ImGui::End();
+                renderProfilerGUI();
             }
 
             // helper
             if(_ImGuiShowHelp){
-                ImVec2 size{300, 400};
+                ImVec2 size{300, 560};
                 ImVec2 pos{0, 0};
                 ImGui::SetNextWindowPos(pos);
                 ImGui::Begin("Help", &_ImGuiShowHelp);
@@ -203,6 +314,18 @@ class Application{
                             "  J: Enable\\Disable cursor\n" \
                             "  Escape: Quit\n" \
                 );
+                ImGui::Text("\nTime:\n" \
+                            "  P: Pause\n" \
+                            "  -/=: Slower/Faster\n" \
+                            "  R: Start/Stop recording\n" \
+                            "  T: Replay the recording\n" \
+                );
+                ImGui::Text("  %.1f s x%.2f%s%s%s", 
+                    _Clock.getTime(), 
+                    _Clock.getScale(), 
+                    _Clock.getIsPaused() ? " paused" : "", 
+                    _Clock.getIsRecording() ? " rec" : "", 
+                    _Clock.getIsReplaying() ? " replay" : "");
                 ImGui::End();
             }
 
@@ -231,7 +354,18 @@ class Application{
         }
 
     public:
-        Application(){}
+        /**
+         * Basic constructor
+         * @param options The options selected on the command line
+        */
+        Application(const ApplicationOptions& options = ApplicationOptions()) : _Options(options){
+            _Width = options._Width;
+            _Height = options._Height;
+            _Clock = SimulationClock(options._SimulationStep);
+            if(_Options._Headless && _Options._FixedTimestep == 0.f){
+                _Options._FixedTimestep = _TargetTime;
+            }
+        }
 
         void init();
         void run();
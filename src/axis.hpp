@@ -36,22 +36,19 @@ class Axis{
 
             glVertexArrayVertexBuffer(_Vao, 0, vbo, 0, 3*sizeof(float));
         
-            auto error = glGetError();
-            if (error != GL_NO_ERROR) {
-                fprintf(stderr, "Failed to initialize the axis!\n\tOpenGL error: %s\n", gluErrorString(error));
-                ErrorHandler::handle(ErrorCodes::GL_ERROR);
-            }
+            ErrorHandler::checkGLError("Failed to initialize the axis!");
         }
 
-        void render(const glm::mat4& view, const glm::mat4& proj){
+        /**
+         * Draw the axis, the view and the projection are in the frame uniforms
+        */
+        void render(){
             glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
             
             glBindVertexArray(_Vao);
             glLineWidth(2.0f);
 
             _Shaders->use();
-            _Shaders->setMat4f("view", view);
-            _Shaders->setMat4f("proj", proj);
 
             _Shaders->setVec4f("color", glm::vec4(1.0f, 0.0f, 0.0f, 1.0f));
             glDrawArrays(GL_LINE_STRIP, 0, 2);
@@ -0,0 +1,114 @@
+#include "benchReport.hpp"
+#include "errorHandler.hpp"
+
+#include <cstdio>
+
+static std::string escapeJSON(const std::string& value){
+    std::string escaped;
+    for(char c : value){
+        if(c == '"' || c == '\\') escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+// the names of the passes as json keys
+static const char* getPassKey(GpuPass pass){
+    switch(pass){
+        case GPU_PASS_GENERATION: return "generation";
+        case GPU_PASS_WIND: return "wind";
+        case GPU_PASS_GEOMETRY: return "geometry";
+        case GPU_PASS_LIGHTING: return "lighting";
+        case GPU_PASS_DEPTH_BLIT: return "depthBlit";
+        default: return "";
+    }
+}
+
+void BenchReport::setGpuTimes(const std::vector<GpuFrameTimes>& history){
+    for(const auto& times : history){
+        if(times._Frame >= _Frames.size()) continue;
+        _Frames[times._Frame]._HasGpuTimes = true;
+        _Frames[times._Frame]._GpuTimes = times._Times;
+    }
+}
+
+void BenchReport::print(const ApplicationOptions& options) const {
+    GLuint nbFrames = _Frames.size();
+    float sum = 0.f;
+    float max = 0.f;
+    for(const auto& frame : _Frames){
+        sum += frame._FrameTime;
+        max = std::max(max, frame._FrameTime);
+    }
+    auto frameTime = [](const BenchFrame& frame){return frame._FrameTime;};
+    auto cpuTime = [](const BenchFrame& frame){return frame._CpuTime;};
+
+    fprintf(stdout, "Headless run: %u frames at %ux%u in %.2f s, %.1f FPS\n",
+        nbFrames, options._Width, options._Height, _WallTime, nbFrames / _WallTime);
+    fprintf(stdout, "Frame time (ms): avg %.2f p50 %.2f p95 %.2f p99 %.2f max %.2f\n",
+        nbFrames > 0 ? sum / nbFrames : 0.f,
+        getPercentile(frameTime, 0.50f), getPercentile(frameTime, 0.95f), getPercentile(frameTime, 0.99f), max);
+    fprintf(stdout, "CPU time (ms): p50 %.2f p95 %.2f p99 %.2f\n",
+        getPercentile(cpuTime, 0.50f), getPercentile(cpuTime, 0.95f), getPercentile(cpuTime, 0.99f));
+    GLuint nbGpuFrames = std::count_if(_Frames.begin(), _Frames.end(),
+        [](const BenchFrame& frame){return frame._HasGpuTimes;});
+    fprintf(stdout, "GPU time (ms), over the %u frames not dropped by the profiler:\n", nbGpuFrames);
+    for(int pass=0; pass<GPU_PASS_COUNT; pass++){
+        auto gpuTime = [pass](const BenchFrame& frame){return frame._GpuTimes[pass];};
+        fprintf(stdout, "  %s: p50 %.2f p95 %.2f p99 %.2f\n",
+            GpuProfiler::getPassName(GpuPass(pass)),
+            getPercentile(gpuTime, 0.50f, true), getPercentile(gpuTime, 0.95f, true), getPercentile(gpuTime, 0.99f, true));
+    }
+}
+
+bool BenchReport::writeJSON(const std::string& path, const ApplicationOptions& options) const {
+    FILE* file = fopen(path.c_str(), "w");
+    if(file == nullptr){
+        fprintf(stderr, "Failed to write the benchmark results: %s!\n", path.c_str());
+        ErrorHandler::handle(ErrorCodes::IO_ERROR, ErrorLevel::WARNING);
+        return false;
+    }
+
+    fprintf(file, "{\n");
+    fprintf(file, "  \"settings\": {\n");
+    fprintf(file, "    \"width\": %u,\n", options._Width);
+    fprintf(file, "    \"height\": %u,\n", options._Height);
+    fprintf(file, "    \"frames\": %u,\n", GLuint(_Frames.size()));
+    fprintf(file, "    \"timestep\": %.6f,\n", options._FixedTimestep);
+    fprintf(file, "    \"simulationStep\": %.6f,\n", options._SimulationStep);
+    fprintf(file, "    \"cameraPath\": \"%s\",\n", escapeJSON(options._CameraPath).c_str());
+    fprintf(file, "    \"pipeline\": \"%s\",\n", options._Pipeline == GRASS_PIPELINE_GEOMETRY ? "geometry" : "pulling");
+    fprintf(file, "    \"culling\": \"%s\",\n", options._Culling == GRASS_CULLING_GPU ? "gpu" : "cpu");
+    fprintf(file, "    \"generation\": \"%s\",\n", options._Generation == GRASS_GENERATION_GPU ? "gpu" : "cpu");
+    fprintf(file, "    \"wind\": \"%s\",\n", options._Wind == WIND_MODE_TEXTURE ? "texture"
+        : options._Wind == WIND_MODE_ANALYTIC ? "analytic" : "compare");
+    fprintf(file, "    \"gpuBudget\": %.3f,\n", options._TargetGpuTime);
+    fprintf(file, "    \"triangleBudget\": %u\n", options._TriangleBudget);
+    fprintf(file, "  },\n");
+    fprintf(file, "  \"wallTime\": %.4f,\n", _WallTime);
+
+    // the frames dropped by the profiler have null GPU times
+    fprintf(file, "  \"frames\": [\n");
+    for(size_t i=0; i<_Frames.size(); i++){
+        const BenchFrame& frame = _Frames[i];
+        fprintf(file, "    {\"frame\": %u, \"time\": %.4f, \"cpuMs\": %.4f, \"frameMs\": %.4f, \"gpuMs\": ",
+            frame._Frame, frame._Time, frame._CpuTime, frame._FrameTime);
+        if(frame._HasGpuTimes){
+            fprintf(file, "{");
+            for(int pass=0; pass<GPU_PASS_COUNT; pass++){
+                fprintf(file, "%s\"%s\": %.4f", pass == 0 ? "" : ", ", getPassKey(GpuPass(pass)), frame._GpuTimes[pass]);
+            }
+            fprintf(file, "}");
+        } else {
+            fprintf(file, "null");
+        }
+        fprintf(file, ", \"bladesGenerated\": %u, \"bladesDrawn\": %u, \"triangles\": %u}%s\n",
+            frame._NbGeneratedBlades, frame._NbDrawnBlades, frame._NbTriangles,
+            i + 1 < _Frames.size() ? "," : "");
+    }
+    fprintf(file, "  ]\n");
+    fprintf(file, "}\n");
+    fclose(file);
+    fprintf(stdout, "Benchmark results written to %s\n", path.c_str());
+    return true;
+}
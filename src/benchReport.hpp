@@ -0,0 +1,94 @@
+#pragma once
+
+#include "gpuProfiler.hpp"
+#include "options.hpp"
+
+#include <algorithm>
+#include <array>
+#include <glad/gl.h>
+#include <string>
+#include <vector>
+
+/**
+ * The measures of a frame of the headless mode
+*/
+struct BenchFrame{
+    GLuint _Frame;
+    float _Time;                // simulation time in s
+    float _CpuTime;             // update and submission of the frame in ms
+    float _FrameTime;           // until the GPU is done with the frame in ms
+    bool _HasGpuTimes;          // false if the profiler dropped the frame
+    std::array<float, GPU_PASS_COUNT> _GpuTimes;
+    GLuint _NbGeneratedBlades;
+    GLuint _NbDrawnBlades;
+    GLuint _NbTriangles;
+};
+
+/**
+ * The results of a headless run, printed as a summary or written as json to compare runs
+*/
+class BenchReport{
+
+    private:
+        std::vector<BenchFrame> _Frames;
+        float _WallTime = 0.f;
+
+    private:
+        /**
+         * Get a percentile of the frames
+         * @param value The value of a frame
+         * @param rank The rank in [0, 1]
+         * @param isGpuTime True to skip the frames dropped by the profiler, their GPU times are unknown
+        */
+        template<typename Value>
+        float getPercentile(Value value, float rank, bool isGpuTime = false) const {
+            std::vector<float> values;
+            values.reserve(_Frames.size());
+            for(const auto& frame : _Frames){
+                if(isGpuTime && !frame._HasGpuTimes) continue;
+                values.push_back(value(frame));
+            }
+            if(values.empty()) return 0.f;
+            auto nth = values.begin() + GLuint(rank * (values.size() - 1));
+            std::nth_element(values.begin(), nth, values.end());
+            return *nth;
+        }
+
+    public:
+        /**
+         * Add a frame, its GPU times are set once the profiler read them
+         * @return The frame to fill
+        */
+        BenchFrame& addFrame(){
+            _Frames.push_back(BenchFrame());
+            BenchFrame& frame = _Frames.back();
+            frame._Frame = _Frames.size() - 1;
+            frame._HasGpuTimes = false;
+            frame._GpuTimes.fill(0.f);
+            return frame;
+        }
+
+        /**
+         * Set the GPU times of the frames
+         * @param history The frames read by the profiler, indexed from the first frame of the run
+        */
+        void setGpuTimes(const std::vector<GpuFrameTimes>& history);
+
+        void setWallTime(float wallTime){
+            _WallTime = wallTime;
+        }
+
+        /**
+         * Print the percentiles of the frame times and of the GPU times
+         * @param options The options of the run
+        */
+        void print(const ApplicationOptions& options) const;
+
+        /**
+         * Write the settings of the run and every frame
+         * @param path The path of the json file
+         * @param options The options of the run
+         * @return False if the file can't be written
+        */
+        bool writeJSON(const std::string& path, const ApplicationOptions& options) const;
+};
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "errorHandler.hpp"
+
+#include <cstdio>
+#include <glad/gl.h>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * A cache of the blades generated by the compute shader
+ * Each slot is a region of the grass buffers holding the blades of one tile,
+ * the least recently used slot is recycled when the cache is full
+*/
+class BladeCache{
+
+    private:
+        /**
+         * The tile stored in each slot (-1 if the slot is free)
+        */
+        std::vector<GLint> _SlotTiles;
+
+        /**
+         * The last frame each slot has been used
+        */
+        std::vector<GLuint> _SlotLastUse;
+
+        /**
+         * The slot of each cached tile
+        */
+        std::unordered_map<GLuint, GLuint> _TileSlots;
+
+        GLuint _Frame = 0;
+
+        // analytics
+        GLuint _FrameHits = 0;
+        GLuint _FrameMisses = 0;
+        GLuint _TotalHits = 0;
+        GLuint _TotalMisses = 0;
+        // tiles without a slot, the cache being too small is only reported the first time
+        GLuint _FrameSkipped = 0;
+        bool _HasReportedFull = false;
+
+    private:
+        /**
+         * Find the slot to fill for a new tile
+         * @return The free or least recently used slot, -1 if all of them are used this frame
+        */
+        GLint findVictim() const {
+            GLint victim = -1;
+            for(GLuint i=0; i<_SlotTiles.size(); i++){
+                if(_SlotTiles[i] == -1) return i;
+                if(_SlotLastUse[i] == _Frame) continue;
+                if(victim == -1 || _SlotLastUse[i] < _SlotLastUse[victim]){
+                    victim = i;
+                }
+            }
+            return victim;
+        }
+
+    public:
+        /**
+         * Basic constructor
+         * @param nbSlots The number of slots in the cache
+        */
+        BladeCache(GLuint nbSlots){
+            _SlotTiles.resize(nbSlots, -1);
+            _SlotLastUse.resize(nbSlots, 0);
+        }
+
+        /**
+         * Start a new frame, reset the frame analytics
+        */
+        void newFrame(){
+            _Frame++;
+            _FrameHits = 0;
+            _FrameMisses = 0;
+            _FrameSkipped = 0;
+        }
+
+        /**
+         * Get the slot of a tile, evicting the least recently used tile on a miss
+         * @param tileId The tile's id
+         * @param slot The slot holding the tile's blades
+         * @param isHit False if the blades of the slot must be generated
+         * @return False if every slot is already used this frame
+        */
+        bool getSlot(GLuint tileId, GLuint& slot, bool& isHit){
+            auto it = _TileSlots.find(tileId);
+            if(it != _TileSlots.end()){
+                slot = it->second;
+                _SlotLastUse[slot] = _Frame;
+                isHit = true;
+                _FrameHits++;
+                _TotalHits++;
+                return true;
+            }
+
+            GLint victim = findVictim();
+            if(victim == -1){
+                _FrameSkipped++;
+                if(!_HasReportedFull){
+                    fprintf(stderr, "Blade cache too small, tile %u skipped!\n", tileId);
+                    ErrorHandler::handle(ErrorCodes::OUT_OF_RANGE, ErrorLevel::WARNING);
+                    _HasReportedFull = true;
+                }
+                return false;
+            }
+            if(_SlotTiles[victim] != -1){
+                _TileSlots.erase(_SlotTiles[victim]);
+            }
+            slot = victim;
+            _SlotTiles[slot] = tileId;
+            _SlotLastUse[slot] = _Frame;
+            _TileSlots[tileId] = slot;
+            isHit = false;
+            _FrameMisses++;
+            _TotalMisses++;
+            return true;
+        }
+
+        /**
+         * Free the slot of a tile if it is cached
+         * @param tileId The tile's id
+         * @return True if the tile was cached
+        */
+        bool release(GLuint tileId){
+            auto it = _TileSlots.find(tileId);
+            if(it == _TileSlots.end()) return false;
+            _SlotTiles[it->second] = -1;
+            _TileSlots.erase(it);
+            return true;
+        }
+
+        /**
+         * Get the tile stored in each slot
+         * @return The tile ids, -1 for the free slots
+        */
+        const std::vector<GLint>& getSlotTiles() const {return _SlotTiles;}
+
+        GLuint getNbSlots() const {return _SlotTiles.size();}
+        GLuint getNbCachedTiles() const {return _TileSlots.size();}
+        GLuint getFrameHits() const {return _FrameHits;}
+        GLuint getFrameMisses() const {return _FrameMisses;}
+        GLuint getFrameSkipped() const {return _FrameSkipped;}
+        GLuint getTotalHits() const {return _TotalHits;}
+        GLuint getTotalMisses() const {return _TotalMisses;}
+};
@@ -0,0 +1,152 @@
+#include "bladeGenerator.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+const GLuint BladeGenerator::_BATCH_SIZE;
+
+float BladeGenerator::rand(float x, float y){
+    float value = std::sin(x * 12.9898f + y * 78.233f) * 43758.5453f;
+    return value - std::floor(value);
+}
+
+glm::vec4 BladeGenerator::getColor(GLuint clumpId){
+    float green = rand(float(clumpId), float(clumpId), _MIN_GREEN, _MAX_GREEN);
+    return glm::vec4(0.05f, 0.2f * green, 0.01f, 1.f);
+}
+
+GLuint BladeGenerator::getGridCell(float x, float z) const {
+    float cellWidth = (1.f * _TileWidth) / _GridNbCols;
+    float cellHeight = (1.f * _TileHeight) / _GridNbLines;
+
+    GLuint cellX = std::min(GLuint(std::floor(x / cellWidth)), _GridNbCols - 1);
+    GLuint cellY = std::min(GLuint(std::floor(z / cellHeight)), _GridNbLines - 1);
+
+    return cellX + cellY * _GridNbCols;
+}
+
+glm::vec2 BladeGenerator::getIntersectionPosition(GLuint cellId, GLuint tileId) const {
+    float randX = rand(float(cellId), float(tileId));
+    float randZ = rand(float(tileId), float(cellId));
+
+    float cellX = float(cellId % _GridNbCols);
+    float cellZ = float(cellId / _GridNbCols);
+
+    float cellWidth = (1.f * _TileWidth) / _GridNbCols;
+    float cellHeight = (1.f * _TileHeight) / _GridNbLines;
+
+    return glm::vec2((cellX + randX) * cellWidth, (cellZ + randZ) * cellHeight);
+}
+
+GLuint BladeGenerator::getClumpId(float x, float z, GLuint tileId) const {
+    GLuint cellId = getGridCell(x, z);
+    GLuint cellX = cellId % _GridNbCols;
+    GLuint cellZ = cellId / _GridNbCols;
+
+    // same order as the compute shader so the ties are broken the same way
+    bool isFirstRow = cellZ == 0;
+    bool isLastRow = cellZ == _GridNbLines - 1;
+    bool isFirstCol = cellX == 0;
+    bool isLastCol = cellX == _GridNbCols - 1;
+    GLuint intersections[9];
+    GLuint nbIntersections = 0;
+    intersections[nbIntersections++] = cellId;
+    if(!isFirstRow) intersections[nbIntersections++] = cellId - _GridNbCols;
+    if(!isLastRow) intersections[nbIntersections++] = cellId + _GridNbCols;
+    if(!isFirstCol) intersections[nbIntersections++] = cellId - 1;
+    if(!isLastCol) intersections[nbIntersections++] = cellId + 1;
+    if(!isFirstRow && !isFirstCol) intersections[nbIntersections++] = cellId - _GridNbCols - 1;
+    if(!isFirstRow && !isLastCol) intersections[nbIntersections++] = cellId - _GridNbCols + 1;
+    if(!isLastRow && !isFirstCol) intersections[nbIntersections++] = cellId + _GridNbCols - 1;
+    if(!isLastRow && !isLastCol) intersections[nbIntersections++] = cellId + _GridNbCols + 1;
+
+    glm::vec2 position(x, z);
+    GLuint bestId = 0;
+    float minDist = glm::distance(position, getIntersectionPosition(intersections[0], tileId));
+    for(GLuint i=1; i<nbIntersections; i++){
+        float curDist = glm::distance(position, getIntersectionPosition(intersections[i], tileId));
+        if(curDist < minDist){
+            minDist = curDist;
+            bestId = i;
+        }
+    }
+    return intersections[bestId];
+}
+
+void BladeGenerator::generateBatch(Batch& batch, GLuint firstBlade, const glm::vec2& tilePos, GLuint tileId) const {
+    float seedTile = float(tileId);
+
+    // position in the tile
+    for(GLuint i=0; i<_BATCH_SIZE; i++){
+        float seedBlade = float(firstBlade + i);
+        batch._RandX[i] = rand(seedBlade, seedTile);
+        batch._RandZ[i] = rand(seedTile, seedBlade);
+    }
+    // the shader draws again until the value isn't null, it almost never happens
+    for(GLuint i=0; i<_BATCH_SIZE; i++){
+        float seedBlade = float(firstBlade + i);
+        for(float factor=2.f; batch._RandX[i] < _EPSILON; factor+=1.f){
+            batch._RandX[i] = rand(seedBlade * factor, seedTile * factor);
+        }
+        for(float factor=2.f; batch._RandZ[i] < _EPSILON; factor+=1.f){
+            batch._RandZ[i] = rand(seedTile * factor, seedBlade * factor);
+        }
+    }
+
+    // clump, branchy so one blade at a time
+    for(GLuint i=0; i<_BATCH_SIZE; i++){
+        float x = batch._RandX[i] * float(_TileWidth);
+        float z = batch._RandZ[i] * float(_TileHeight);
+        batch._ClumpId[i] = float(getClumpId(x, z, tileId));
+        batch._PosX[i] = x + tilePos.x;
+        batch._PosZ[i] = z + tilePos.y;
+    }
+
+    // shape
+    for(GLuint i=0; i<_BATCH_SIZE; i++){
+        float posX = batch._PosX[i];
+        float posZ = batch._PosZ[i];
+        float clumpId = batch._ClumpId[i];
+
+        float height = rand(posX, posZ, _MIN_HEIGHT, _MAX_HEIGHT);
+        float tilt = rand(clumpId, posX * posZ, height / 3.f, height);
+        float bendX = rand(clumpId, posX, tilt / 3.f, tilt);
+        float minBendY = (height / tilt) * bendX + height / 3.f;
+
+        batch._Height[i] = height;
+        batch._Width[i] = rand(posX, posZ, _MIN_WIDTH, _MAX_WIDTH);
+        batch._Rotation[i] = glm::radians(rand(posX * posZ, clumpId) * 360.f);
+        batch._Tilt[i] = tilt;
+        batch._BendX[i] = bendX;
+        batch._BendY[i] = rand(posZ, clumpId, minBendY, height);
+    }
+}
+
+void BladeGenerator::generate(const glm::vec2& tilePos, GLuint tileId, GLuint clumpsStart, GLuint nbBlades,
+    GrassBlade* blades, GrassClump* clumps) const {
+    for(GLuint i=0; i<getNbClumps(); i++){
+        clumps[i] = {getColor(i)};
+    }
+
+    int nbBatches = (nbBlades + _BATCH_SIZE - 1) / _BATCH_SIZE;
+    #pragma omp parallel for
+    for(int b=0; b<nbBatches; b++){
+        GLuint firstBlade = b * _BATCH_SIZE;
+        GLuint batchSize = std::min(_BATCH_SIZE, nbBlades - firstBlade);
+
+        Batch batch;
+        generateBatch(batch, firstBlade, tilePos, tileId);
+
+        for(GLuint i=0; i<batchSize; i++){
+            blades[firstBlade + i] = GrassBlade::pack(
+                glm::vec4(batch._PosX[i], 0.f, batch._PosZ[i], 1.f),
+                batch._Height[i],
+                batch._Width[i],
+                clumpsStart + GLuint(batch._ClumpId[i]),
+                batch._Rotation[i],
+                batch._Tilt[i],
+                glm::vec2(batch._BendX[i], batch._BendY[i])
+            );
+        }
+    }
+}
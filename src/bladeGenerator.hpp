@@ -0,0 +1,108 @@
+#pragma once
+
+#include "grassBlade.hpp"
+
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+
+/**
+ * CPU reference of the blades generation of grassCompute.glsl, it doesn't need a GL context
+ * The blades are generated by batches stored as structures of arrays, one stage over the whole batch at a time.
+ * The stages call the scalar std::sin of the hash so they aren't vectorized, the results match the compute shader
+ * as long as the GPU's sin matches the CPU's (grassBench --verify-generation)
+*/
+class BladeGenerator{
+
+    public:
+        static const GLuint _BATCH_SIZE = 16;
+
+    private:
+        // same constants as grassCompute.glsl
+        static constexpr float _MAX_WIDTH = 0.05f;
+        static constexpr float _MIN_WIDTH = 0.02f;
+        static constexpr float _MAX_HEIGHT = 0.5f;
+        static constexpr float _MIN_HEIGHT = 0.3f;
+        static constexpr float _MAX_GREEN = 1.5f;
+        static constexpr float _MIN_GREEN = 0.5f;
+        static constexpr float _EPSILON = 1e-4f;
+
+        /**
+         * A batch of blades, one array per attribute
+        */
+        struct Batch{
+            alignas(32) float _RandX[_BATCH_SIZE];
+            alignas(32) float _RandZ[_BATCH_SIZE];
+            alignas(32) float _PosX[_BATCH_SIZE];
+            alignas(32) float _PosZ[_BATCH_SIZE];
+            alignas(32) float _ClumpId[_BATCH_SIZE];
+            alignas(32) float _Height[_BATCH_SIZE];
+            alignas(32) float _Width[_BATCH_SIZE];
+            alignas(32) float _Rotation[_BATCH_SIZE];
+            alignas(32) float _Tilt[_BATCH_SIZE];
+            alignas(32) float _BendX[_BATCH_SIZE];
+            alignas(32) float _BendY[_BATCH_SIZE];
+        };
+
+        GLuint _TileWidth;
+        GLuint _TileHeight;
+        GLuint _GridNbCols;
+        GLuint _GridNbLines;
+
+    private:
+        // the last batch of a tile is generated whole, its extra blades are dropped
+        void generateBatch(Batch& batch, GLuint firstBlade, const glm::vec2& tilePos, GLuint tileId) const;
+
+        GLuint getGridCell(float x, float z) const;
+        glm::vec2 getIntersectionPosition(GLuint cellId, GLuint tileId) const;
+
+    public:
+        /**
+         * Basic constructor
+         * @param tileWidth The tile's width
+         * @param tileHeight The tile's height
+         * @param gridNbCols The number of columns of the clumps grid
+         * @param gridNbLines The number of lines of the clumps grid
+        */
+        BladeGenerator(GLuint tileWidth, GLuint tileHeight, GLuint gridNbCols, GLuint gridNbLines)
+            : _TileWidth(tileWidth), _TileHeight(tileHeight),
+            _GridNbCols(gridNbCols), _GridNbLines(gridNbLines){}
+
+        /**
+         * Generate the blades and the clump table of a tile, as one dispatch of grassCompute.glsl
+         * @param tilePos The tile's position
+         * @param tileId The tile's id
+         * @param clumpsStart The index of the tile's clump table in the clumps buffer
+         * @param nbBlades The number of blades to generate
+         * @param blades The blades of the tile, nbBlades records
+         * @param clumps The clump table of the tile, one record per grid cell
+        */
+        void generate(const glm::vec2& tilePos, GLuint tileId, GLuint clumpsStart, GLuint nbBlades,
+            GrassBlade* blades, GrassClump* clumps) const;
+
+        /**
+         * Get the clump of a blade, the nearest jittered intersection of the grid
+         * @param x The blade's x coordinate in the tile
+         * @param z The blade's z coordinate in the tile
+         * @param tileId The tile's id
+         * @return The index of the clump in the tile's clump table
+        */
+        GLuint getClumpId(float x, float z, GLuint tileId) const;
+
+        /**
+         * Get the color of a clump
+         * @param clumpId The index of the clump in the tile's clump table
+        */
+        static glm::vec4 getColor(GLuint clumpId);
+
+        /**
+         * The hash of the shaders, fract(sin(dot(seed, (12.9898, 78.233))) * 43758.5453)
+         * @return A random value in [0, 1[
+        */
+        static float rand(float x, float y);
+
+        static float rand(float x, float y, float mini, float maxi){
+            return rand(x, y) * (maxi - mini) + mini;
+        }
+
+        GLuint getNbClumps() const {return _GridNbCols * _GridNbLines;}
+};
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <array>
+#include <glad/gl.h>
+
+/**
+ * Read back a small range of a buffer written by the GPU without waiting for it
+ * Each frame in flight copies the range into its own buffer behind a fence,
+ * the newest copy whose fence is signaled is read a few frames later
+*/
+class BufferReadback{
+
+    public:
+        // frames in flight
+        static const GLuint _NB_FRAMES = 4;
+
+    private:
+        GLsizeiptr _Size = 0;
+        std::array<GLuint, _NB_FRAMES> _Buffers;
+        std::array<GLsync, _NB_FRAMES> _Fences;
+        GLuint _Current = 0;
+
+    private:
+        void release(GLuint slot){
+            if(_Fences[slot] == nullptr) return;
+            glDeleteSync(_Fences[slot]);
+            _Fences[slot] = nullptr;
+        }
+
+    public:
+        /**
+         * Basic constructor
+         * @param size The size of the range in bytes
+        */
+        BufferReadback(GLsizeiptr size) : _Size(size){
+            glCreateBuffers(_NB_FRAMES, _Buffers.data());
+            for(GLuint buffer : _Buffers){
+                glNamedBufferStorage(buffer, _Size, nullptr, GL_CLIENT_STORAGE_BIT);
+            }
+            _Fences.fill(nullptr);
+        }
+
+        ~BufferReadback(){
+            for(GLuint slot=0; slot<_NB_FRAMES; slot++){
+                release(slot);
+            }
+            glDeleteBuffers(_NB_FRAMES, _Buffers.data());
+        }
+
+        BufferReadback(const BufferReadback&) = delete;
+        BufferReadback& operator=(const BufferReadback&) = delete;
+
+        /**
+         * Copy the range once the previous commands are done, a copy still pending when its slot is reused is dropped
+         * The writes of the shaders must be made visible with GL_BUFFER_UPDATE_BARRIER_BIT before
+         * @param source The buffer
+         * @param offset The start of the range in the buffer
+        */
+        void copy(GLuint source, GLintptr offset){
+            release(_Current);
+            glCopyNamedBufferSubData(source, _Buffers[_Current], offset, 0, _Size);
+            _Fences[_Current] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            _Current = (_Current + 1) % _NB_FRAMES;
+        }
+
+        /**
+         * Read the newest copy the GPU is done with, the older ones are dropped
+         * @param data The destination, of the range's size
+         * @return False if no copy is ready, data is left as is
+        */
+        bool read(void* data){
+            for(GLuint i=1; i<=_NB_FRAMES; i++){
+                GLuint slot = (_Current + _NB_FRAMES - i) % _NB_FRAMES;
+                if(_Fences[slot] == nullptr) continue;
+                GLenum status = glClientWaitSync(_Fences[slot], 0, 0);
+                if(status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) continue;
+
+                glGetNamedBufferSubData(_Buffers[slot], 0, _Size, data);
+                // the older copies are of previous frames
+                for(GLuint j=i; j<=_NB_FRAMES; j++){
+                    release((_Current + _NB_FRAMES - j) % _NB_FRAMES);
+                }
+                return true;
+            }
+            return false;
+        }
+};
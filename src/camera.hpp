@@ -70,6 +70,27 @@ class Camera{
             return _Eye;
         }
 
+        float getYaw() const {
+            return _Yaw;
+        }
+
+        float getPitch() const {
+            return _Pitch;
+        }
+
+        /**
+         * Place the camera
+         * @param position The camera's position
+         * @param yaw The yaw in degrees, -90 looks toward -z
+         * @param pitch The pitch in degrees
+        */
+        void setPose(const glm::vec3& position, float yaw, float pitch){
+            _Eye = position;
+            _Yaw = yaw;
+            _Pitch = pitch;
+            updateCameraVectors();
+        }
+
         glm::mat4 getView() const {
             return glm::lookAt(_Eye, _Eye + _At, _Up);
         }
@@ -0,0 +1,86 @@
+#include "cameraPath.hpp"
+#include "errorHandler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <glm/gtc/constants.hpp>
+#include <sstream>
+
+bool CameraPath::load(const std::string& path){
+    std::ifstream file(path);
+    if(!file){
+        fprintf(stderr, "Failed to read the camera path: %s!\n", path.c_str());
+        ErrorHandler::handle(ErrorCodes::IO_ERROR, ErrorLevel::WARNING);
+        return false;
+    }
+
+    _Keyframes.clear();
+    std::string line;
+    GLuint lineNumber = 0;
+    while(std::getline(file, line)){
+        lineNumber++;
+        size_t first = line.find_first_not_of(" \t\r");
+        if(first == std::string::npos || line[first] == '#') continue;
+
+        CameraKeyframe keyframe;
+        std::istringstream values(line);
+        values >> keyframe._Time >> keyframe._Position.x >> keyframe._Position.y >> keyframe._Position.z
+            >> keyframe._Yaw >> keyframe._Pitch;
+        if(!values){
+            fprintf(stderr, "Bad keyframe at line %u of %s!\n", lineNumber, path.c_str());
+            ErrorHandler::handle(ErrorCodes::BAD_VALUE, ErrorLevel::WARNING);
+            continue;
+        }
+        addKeyframe(keyframe);
+    }
+    return !_Keyframes.empty();
+}
+
+CameraPath CameraPath::createOrbit(const glm::vec3& center, float radius, float height, float duration){
+    CameraPath path;
+    const int nbKeyframes = 36;
+    float pitch = -glm::degrees(std::atan2(height, radius));
+    for(int i=0; i<=nbKeyframes; i++){
+        float alpha = float(i) / nbKeyframes;
+        float angle = 2.f * glm::pi<float>() * alpha;
+        glm::vec3 position = center + glm::vec3(radius * std::cos(angle), height, radius * std::sin(angle));
+        // the yaw keeps growing so the interpolation doesn't turn back
+        path.addKeyframe({alpha * duration, position, glm::degrees(angle) + 180.f, pitch});
+    }
+    return path;
+}
+
+void CameraPath::addKeyframe(const CameraKeyframe& keyframe){
+    auto it = std::upper_bound(_Keyframes.begin(), _Keyframes.end(), keyframe._Time,
+        [](float time, const CameraKeyframe& other){return time < other._Time;}
+    );
+    _Keyframes.insert(it, keyframe);
+}
+
+void CameraPath::apply(float time, Camera& camera) const {
+    if(_Keyframes.empty()) return;
+    if(time <= _Keyframes.front()._Time){
+        const CameraKeyframe& first = _Keyframes.front();
+        camera.setPose(first._Position, first._Yaw, first._Pitch);
+        return;
+    }
+    if(time >= _Keyframes.back()._Time){
+        const CameraKeyframe& last = _Keyframes.back();
+        camera.setPose(last._Position, last._Yaw, last._Pitch);
+        return;
+    }
+
+    auto next = std::upper_bound(_Keyframes.begin(), _Keyframes.end(), time,
+        [](float time, const CameraKeyframe& other){return time < other._Time;}
+    );
+    const CameraKeyframe& to = *next;
+    const CameraKeyframe& from = *(next - 1);
+    float alpha = (time - from._Time) / (to._Time - from._Time);
+    camera.setPose(
+        glm::mix(from._Position, to._Position, alpha),
+        glm::mix(from._Yaw, to._Yaw, alpha),
+        glm::mix(from._Pitch, to._Pitch, alpha)
+    );
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "camera.hpp"
+
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+/**
+ * A pose of the camera at a given time
+*/
+struct CameraKeyframe{
+    float _Time;            // s
+    glm::vec3 _Position;
+    float _Yaw;             // degrees
+    float _Pitch;           // degrees
+};
+
+/**
+ * A scripted camera path, the camera is interpolated linearly between its keyframes
+*/
+class CameraPath{
+
+    private:
+        // sorted by time
+        std::vector<CameraKeyframe> _Keyframes;
+
+    public:
+        /**
+         * Load the keyframes of a file, one "time x y z yaw pitch" per line, the lines starting with # are ignored
+         * @param path The path to the file
+         * @return False if the file can't be read or has no keyframe
+        */
+        bool load(const std::string& path);
+
+        /**
+         * Create a path turning around a point while looking at it
+         * @param center The point looked at
+         * @param radius The distance to the center on the ground
+         * @param height The height of the camera above the center
+         * @param duration The time of a full turn in s
+        */
+        static CameraPath createOrbit(const glm::vec3& center, float radius, float height, float duration);
+
+        void addKeyframe(const CameraKeyframe& keyframe);
+
+        /**
+         * Place the camera at a time of the path, the ends of the path are held
+         * @param time The time in s
+         * @param camera The camera
+        */
+        void apply(float time, Camera& camera) const;
+
+        float getDuration() const {
+            return _Keyframes.empty() ? 0.f : _Keyframes.back()._Time;
+        }
+
+        const std::vector<CameraKeyframe>& getKeyframes() const {
+            return _Keyframes;
+        }
+};
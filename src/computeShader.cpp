@@ -1,18 +1,25 @@
 #include "computeShader.hpp"
 #include "errorHandler.hpp"
+#include "programCache.hpp"
 
 #include <fstream>
 #include <sstream>
 #include <GL/glext.h>
 
-ComputeShader::ComputeShader(const std::string& shaderPath){
+ComputeShader::ComputeShader(const std::string& shaderPath, const std::string& defines){
     _Id = glCreateProgram();
 
-    const std::string code = openShaderFile(shaderPath);
-    GLuint codeID = compile(code);
-    link(codeID);
+    const std::string code = ProgramCache::addDefines(ProgramCache::addIncludes(openShaderFile(shaderPath), shaderPath), defines);
+    const std::string key = ProgramCache::getKey({code});
+    if(!ProgramCache::load(_Id, key)){
+        GLuint codeID = compile(code);
+        glProgramParameteri(_Id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        link(codeID);
 
-    deleteShader(codeID);
+        deleteShader(codeID);
+        ProgramCache::save(_Id, key);
+    }
+    _Uniforms.resolve(_Id);
 }
 
 const std::string ComputeShader::openShaderFile(const std::string& path) const{
@@ -1,20 +1,28 @@
 #pragma once
 
 #include <glm/gtc/type_ptr.hpp>
+#include <memory>
 #include <string>
 #include <glad/gl.h>
 #include <GLFW/glfw3.h>
 #include <GL/gl.h>
 #include "errorHandler.hpp"
+#include "uniformLocations.hpp"
 #include <glm/glm.hpp>
 #include <GL/glu.h>
 
+class ComputeShader;
+using ComputeShaderPointer = std::shared_ptr<ComputeShader>;
+
 class ComputeShader{
 
     public:
         GLuint _Id;
 
     private:
+        // resolved once the program is linked, the uniforms are set without binding the program
+        UniformLocations _Uniforms;
+
         GLuint compile(const std::string& code) const;
         void link(GLuint shader);
         const std::string openShaderFile(const std::string& path) const;
@@ -22,37 +30,24 @@ class ComputeShader{
             glDeleteShader(shader);
         }
 
-        void checkError(const std::string& name) const{
-            auto error = glGetError();
-            if (error != GL_NO_ERROR) {
-                fprintf(stderr, "Failed to set %s!\n\tOpenGL error: %s\n", name.c_str(), gluErrorString(error));
-                ErrorHandler::handle(ErrorCodes::GL_ERROR);
-            }
-        }
-
-        GLint getUniformLocation(const std::string& name) const {
-            GLint uniformLocation = glGetUniformLocation(_Id, name.c_str());
-            if (uniformLocation == -1) {
-                fprintf(stderr, "Failed to set %s!\n\terror: Uniform not found!\n", name.c_str());
-                ErrorHandler::handle(ErrorCodes::GL_ERROR);
-            }
-            return uniformLocation;
-        }
-
     public:
-        ComputeShader(const std::string& shaderPath);
+        /**
+         * Basic constructor, the program is loaded from the program cache when it is there
+         * @param shaderPath The path to the compute shader
+         * @param defines The lines added after the shader's #version
+        */
+        ComputeShader(const std::string& shaderPath, const std::string& defines = "");
         
         ~ComputeShader(){
-            glDeleteShader(_Id);
+            glDeleteProgram(_Id);
         }
 
+        ComputeShader(const ComputeShader&) = delete;
+        ComputeShader& operator=(const ComputeShader&) = delete;
+
         void use() const {
             glUseProgram(_Id);
-            auto error = glGetError();
-            if (error != GL_NO_ERROR) {
-                fprintf(stderr, "Failed to use the compute shader!\n\tOpenGL error: %s\n", gluErrorString(error));
-                ErrorHandler::handle(ErrorCodes::GL_ERROR);
-            }
+            ErrorHandler::checkGLError("Failed to use the compute shader!");
         }
 
         /**
@@ -60,10 +55,8 @@ class ComputeShader{
          * @param name The variable's name
          * @param val The variable's value
         */
-        void setBool(const std::string& name, bool val) const {
-            use();
-            glUniform1i(getUniformLocation(name), (GLuint)val);
-            checkError(name);
+        void setBool(const UniformName& name, bool val) const {
+            glProgramUniform1i(_Id, _Uniforms.get(name), (GLuint)val);
         }
 
         /**
@@ -71,10 +64,8 @@ class ComputeShader{
          * @param name The variable's name
          * @param val The variable's value
         */
-        void setInt(const std::string& name, int val) const {
-            use();
-            glUniform1i(getUniformLocation(name), val);
-            checkError(name);
+        void setInt(const UniformName& name, int val) const {
+            glProgramUniform1i(_Id, _Uniforms.get(name), val);
         }
 
         /**
@@ -82,10 +73,8 @@ class ComputeShader{
          * @param name The variable's name
          * @param val The variable's value
         */
-        void setFloat(const std::string& name, float val) const {
-            use();
-            glUniform1f(getUniformLocation(name), val);
-            checkError(name);
+        void setFloat(const UniformName& name, float val) const {
+            glProgramUniform1f(_Id, _Uniforms.get(name), val);
         }
 
         /**
@@ -93,10 +82,8 @@ class ComputeShader{
          * @param name The variable's name
          * @param val The variable's value
         */
-        void setMat4f(const std::string& name, const glm::mat4x4& val) const {
-            use();
-            glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, glm::value_ptr(val));
-            checkError(name);
+        void setMat4f(const UniformName& name, const glm::mat4x4& val) const {
+            glProgramUniformMatrix4fv(_Id, _Uniforms.get(name), 1, GL_FALSE, glm::value_ptr(val));
         }
 
         /**
@@ -104,10 +91,8 @@ class ComputeShader{
          * @param name The variable's name
          * @param val The variable's value
         */
-        void setVec3f(const std::string& name, const glm::vec3& val) const {
-            use();
-            glUniform3fv(getUniformLocation(name), 1, glm::value_ptr(val));
-            checkError(name);
+        void setVec3f(const UniformName& name, const glm::vec3& val) const {
+            glProgramUniform3fv(_Id, _Uniforms.get(name), 1, glm::value_ptr(val));
         }
 
         /**
@@ -115,10 +100,8 @@ class ComputeShader{
          * @param name The variable's name
          * @param val The variable's value
         */
-        void setVec2f(const std::string& name, const glm::vec2& val) const {
-            use();
-            glUniform2fv(getUniformLocation(name), 1, glm::value_ptr(val));
-            checkError(name);
+        void setVec2f(const UniformName& name, const glm::vec2& val) const {
+            glProgramUniform2fv(_Id, _Uniforms.get(name), 1, glm::value_ptr(val));
         }
 
         /**
@@ -126,10 +109,8 @@ class ComputeShader{
          * @param name The variable's name
          * @param val The variable's value
         */
-        void setVec4f(const std::string& name, const glm::vec4& val) const {
-            use();
-            glUniform4fv(getUniformLocation(name), 1, glm::value_ptr(val));
-            checkError(name);
+        void setVec4f(const UniformName& name, const glm::vec4& val) const {
+            glProgramUniform4fv(_Id, _Uniforms.get(name), 1, glm::value_ptr(val));
         }
 
 };
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <iostream>
 
 #include <glad/gl.h>
+#include <GL/glu.h>
 #include <stdarg.h>
 
 /**
@@ -39,6 +40,11 @@ class ErrorHandler{
         */
         ErrorHandler(){};
 
+        static bool& getIsDebugOutputEnabled(){
+            static bool isDebugOutputEnabled = false;
+            return isDebugOutputEnabled;
+        }
+
     public:
         /**
          * Handle the error
@@ -61,4 +67,28 @@ class ErrorHandler{
                     }
             }
         }
+
+        /**
+         * Check the GL error flag, every call can synchronize with the driver
+         * Compiled out without GRASS_GL_CHECKS, and skipped when the debug output reports the errors
+         * @param msg The error message
+        */
+        static void checkGLError(const char* msg){
+#ifdef GRASS_GL_CHECKS
+            if(getIsDebugOutputEnabled()) return;
+            GLenum error = glGetError();
+            if (error != GL_NO_ERROR) {
+                fprintf(stderr, "%s\n\tOpenGL error: %s\n", msg, gluErrorString(error));
+                handle(ErrorCodes::GL_ERROR);
+            }
+#endif
+        }
+
+        /**
+         * Let the GL debug output report the GL errors instead of the error flag
+         * @param isEnabled True if the debug output callback is installed
+        */
+        static void setDebugOutputEnabled(bool isEnabled){
+            getIsDebugOutputEnabled() = isEnabled;
+        }
 };
\ No newline at end of file
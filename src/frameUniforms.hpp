@@ -0,0 +1,74 @@
+#pragma once
+
+#include "errorHandler.hpp"
+#include "frustum.hpp"
+
+#include <array>
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+#include <GL/glu.h>
+
+/**
+ * The per frame data shared by every program (std140)
+ * Must match the FrameUniformsBlock of the shaders
+*/
+struct FrameUniformsData{
+    glm::mat4 _View;
+    glm::mat4 _Proj;
+    glm::vec3 _CamPos;
+    float _Time;
+    std::array<glm::vec4, 6> _FrustumPlanes;    // normal and distance to the origin
+};
+
+static_assert(sizeof(FrameUniformsData) == 240, "FrameUniformsData must follow the std140 layout");
+
+/**
+ * The uniform buffer of the per frame data, uploaded once per frame
+*/
+class FrameUniforms{
+
+    public:
+        // uniform buffer binding of the FrameUniformsBlock
+        static const GLuint _BINDING = 0;
+
+    private:
+        GLuint _Buffer = 0;
+        FrameUniformsData _Data;
+
+    public:
+        FrameUniforms(){
+            glCreateBuffers(1, &_Buffer);
+            glNamedBufferStorage(_Buffer, sizeof(FrameUniformsData), nullptr, GL_DYNAMIC_STORAGE_BIT);
+            glBindBufferBase(GL_UNIFORM_BUFFER, _BINDING, _Buffer);
+
+            ErrorHandler::checkGLError("Failed to initialize the frame uniforms!");
+        }
+
+        ~FrameUniforms(){
+            glDeleteBuffers(1, &_Buffer);
+        }
+
+        FrameUniforms(const FrameUniforms&) = delete;
+        FrameUniforms& operator=(const FrameUniforms&) = delete;
+
+        /**
+         * Upload the data of the frame
+         * @param view The view matrix
+         * @param proj The projection matrix
+         * @param cameraPosition The camera's position
+         * @param time The time of the animations in s
+         * @param frustum The camera's frustum
+        */
+        void update(const glm::mat4& view, const glm::mat4& proj, const glm::vec3& cameraPosition,
+            float time, const Frustum& frustum){
+            _Data._View = view;
+            _Data._Proj = proj;
+            _Data._CamPos = cameraPosition;
+            _Data._Time = time;
+            std::array<Plane, 6> planes = frustum.getPlanes();
+            for(int i=0; i<6; i++){
+                _Data._FrustumPlanes[i] = planes[i].getEquation();
+            }
+            glNamedBufferSubData(_Buffer, 0, sizeof(FrameUniformsData), &_Data);
+        }
+};
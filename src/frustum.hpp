@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <glm/glm.hpp>
 
 struct Plane{
@@ -18,6 +19,21 @@ struct Plane{
 	{
 		return glm::dot(_Normal, point) - _Distance;
 	}
+
+	// normal and distance packed for the shaders
+	glm::vec4 getEquation() const
+	{
+		return glm::vec4(_Normal, _Distance);
+	}
+};
+
+/**
+ * @enum Position of a box relative to the frustum
+*/
+enum FrustumTest{
+    FRUSTUM_OUTSIDE,
+    FRUSTUM_INTERSECT,
+    FRUSTUM_INSIDE,
 };
 
 struct Frustum{
@@ -27,4 +43,35 @@ struct Frustum{
     Plane _RightFace;
     Plane _FarFace;
     Plane _NearFace;
+
+    std::array<Plane, 6> getPlanes() const {
+        return {{_TopFace, _BottomFace, _LeftFace, _RightFace, _FarFace, _NearFace}};
+    }
+
+    /**
+     * Classify an axis aligned box with its p-vertex and n-vertex
+     * The p-vertex is the corner furthest along a plane's normal, the box is outside if it is behind the plane
+     * The n-vertex is the opposite corner, the box is inside if it is in front of every plane
+     * @param minCorner The box's corner with the lowest coordinates
+     * @param maxCorner The box's corner with the highest coordinates
+    */
+    FrustumTest testBox(const glm::vec3& minCorner, const glm::vec3& maxCorner) const {
+        FrustumTest result = FRUSTUM_INSIDE;
+        for(const Plane& plane : getPlanes()){
+            const glm::vec3& normal = plane._Normal;
+            glm::vec3 pVertex(
+                normal.x >= 0.f ? maxCorner.x : minCorner.x,
+                normal.y >= 0.f ? maxCorner.y : minCorner.y,
+                normal.z >= 0.f ? maxCorner.z : minCorner.z
+            );
+            glm::vec3 nVertex(
+                normal.x >= 0.f ? minCorner.x : maxCorner.x,
+                normal.y >= 0.f ? minCorner.y : maxCorner.y,
+                normal.z >= 0.f ? minCorner.z : maxCorner.z
+            );
+            if(plane.getSignedDistanceToPlane(pVertex) < 0.f) return FRUSTUM_OUTSIDE;
+            if(plane.getSignedDistanceToPlane(nVertex) < 0.f) result = FRUSTUM_INTERSECT;
+        }
+        return result;
+    }
 };
\ No newline at end of file
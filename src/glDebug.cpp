@@ -0,0 +1,113 @@
+#include "glDebug.hpp"
+#include "errorHandler.hpp"
+
+#include <cstdio>
+
+const char* GLDebug::getSourceName(GLenum source){
+    switch(source){
+        case GL_DEBUG_SOURCE_API: return "api";
+        case GL_DEBUG_SOURCE_WINDOW_SYSTEM: return "window system";
+        case GL_DEBUG_SOURCE_SHADER_COMPILER: return "shader compiler";
+        case GL_DEBUG_SOURCE_THIRD_PARTY: return "third party";
+        case GL_DEBUG_SOURCE_APPLICATION: return "application";
+        default: return "other";
+    }
+}
+
+const char* GLDebug::getTypeName(GLenum type){
+    switch(type){
+        case GL_DEBUG_TYPE_ERROR: return "error";
+        case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "deprecated behavior";
+        case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR: return "undefined behavior";
+        case GL_DEBUG_TYPE_PORTABILITY: return "portability";
+        case GL_DEBUG_TYPE_PERFORMANCE: return "performance";
+        case GL_DEBUG_TYPE_MARKER: return "marker";
+        case GL_DEBUG_TYPE_PUSH_GROUP: return "push group";
+        case GL_DEBUG_TYPE_POP_GROUP: return "pop group";
+        default: return "other";
+    }
+}
+
+const char* GLDebug::getSeverityName(GLenum severity){
+    switch(severity){
+        case GL_DEBUG_SEVERITY_HIGH: return "high";
+        case GL_DEBUG_SEVERITY_MEDIUM: return "medium";
+        case GL_DEBUG_SEVERITY_LOW: return "low";
+        default: return "notification";
+    }
+}
+
+bool GLDebug::parseSeverity(const std::string& name, GLenum& severity){
+    const GLenum severities[] = {
+        GL_DEBUG_SEVERITY_HIGH, GL_DEBUG_SEVERITY_MEDIUM, GL_DEBUG_SEVERITY_LOW, GL_DEBUG_SEVERITY_NOTIFICATION
+    };
+    for(GLenum candidate : severities){
+        if(name == getSeverityName(candidate)){
+            severity = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+void GLAD_API_PTR GLDebug::callback(GLenum source, GLenum type, GLuint id, GLenum severity,
+    GLsizei length, const GLchar* message, const void* userParam){
+    fprintf(stderr, "OpenGL %s (%s, %s severity) %u: %.*s\n",
+        getTypeName(type), getSourceName(source), getSeverityName(severity), id, (int)length, message
+    );
+    // the other messages are only reported
+    if(type == GL_DEBUG_TYPE_ERROR){
+        // exiting from a thread of the driver while the main thread uses the context is undefined
+        if(getIsSynchronous()){
+            ErrorHandler::handle(ErrorCodes::GL_ERROR);
+        }
+        getHasError() = true;
+    }
+    else if(severity == GL_DEBUG_SEVERITY_HIGH){
+        ErrorHandler::handle(ErrorCodes::GL_ERROR, ErrorLevel::WARNING);
+    }
+}
+
+void GLDebug::checkErrors(){
+    if(!getHasError().exchange(false)) return;
+    fprintf(stderr, "The GL debug output reported an error!\n");
+    ErrorHandler::handle(ErrorCodes::GL_ERROR);
+}
+
+bool GLDebug::enable(GLenum minSeverity, bool isSynchronous){
+    GLint flags = 0;
+    glGetIntegerv(GL_CONTEXT_FLAGS, &flags);
+    if(!(flags & GL_CONTEXT_FLAG_DEBUG_BIT)){
+        fprintf(stderr, "The OpenGL context has no debug output!\n");
+        ErrorHandler::handle(ErrorCodes::GL_ERROR, ErrorLevel::WARNING);
+        return false;
+    }
+
+    // asynchronous by default, the driver reports the messages from its own threads
+    glEnable(GL_DEBUG_OUTPUT);
+    getIsSynchronous() = isSynchronous;
+    if(isSynchronous){
+        glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    }
+    glDebugMessageCallback(callback, nullptr);
+
+    // severity, from the highest to the minimum one
+    glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_FALSE);
+    const GLenum severities[] = {
+        GL_DEBUG_SEVERITY_HIGH, GL_DEBUG_SEVERITY_MEDIUM, GL_DEBUG_SEVERITY_LOW, GL_DEBUG_SEVERITY_NOTIFICATION
+    };
+    for(GLenum severity : severities){
+        glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, severity, 0, nullptr, GL_TRUE);
+        if(severity == minSeverity) break;
+    }
+    // type, the debug groups only annotate the captures
+    const GLenum groupTypes[] = {GL_DEBUG_TYPE_MARKER, GL_DEBUG_TYPE_PUSH_GROUP, GL_DEBUG_TYPE_POP_GROUP};
+    for(GLenum type : groupTypes){
+        glDebugMessageControl(GL_DONT_CARE, type, GL_DONT_CARE, 0, nullptr, GL_FALSE);
+    }
+    // source, the application's own messages
+    glDebugMessageControl(GL_DEBUG_SOURCE_APPLICATION, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_FALSE);
+
+    ErrorHandler::setDebugOutputEnabled(true);
+    return true;
+}
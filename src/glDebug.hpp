@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <glad/gl.h>
+#include <string>
+
+/**
+ * The GL debug output (KHR_debug), the driver reports the errors asynchronously
+ * instead of the error flag being polled after the GL calls
+ * The callback may run on a thread of the driver, it only records the errors and checkErrors stops the program
+ * on the main thread, unless the output is synchronous and the error is raised by the GL call itself
+*/
+class GLDebug{
+    private:
+        /**
+         * Private constructor to make the class purely static
+        */
+        GLDebug(){};
+
+        static std::atomic<bool>& getHasError(){
+            static std::atomic<bool> hasError(false);
+            return hasError;
+        }
+
+        static bool& getIsSynchronous(){
+            static bool isSynchronous = false;
+            return isSynchronous;
+        }
+
+        static void GLAD_API_PTR callback(GLenum source, GLenum type, GLuint id, GLenum severity,
+            GLsizei length, const GLchar* message, const void* userParam);
+
+    public:
+        static const char* getSourceName(GLenum source);
+        static const char* getTypeName(GLenum type);
+        static const char* getSeverityName(GLenum severity);
+
+        /**
+         * Parse a severity
+         * @param name high, medium, low or notification
+         * @param severity The GL severity
+         * @return False if the name is unknown
+        */
+        static bool parseSeverity(const std::string& name, GLenum& severity);
+
+        /**
+         * Install the callback, the context must have been created with the debug flag
+         * The messages under the minimum severity, the debug groups and the messages of the application are filtered out
+         * @param minSeverity The lowest severity reported
+         * @param isSynchronous True to report the messages during the GL call raising them, slower but its stack is kept
+         * @return False if the context has no debug output
+        */
+        static bool enable(GLenum minSeverity, bool isSynchronous = false);
+
+        /**
+         * Stop the program if the callback recorded an error since the last check, on the main thread
+        */
+        static void checkErrors();
+};
@@ -0,0 +1,282 @@
+#pragma once
+
+#include "errorHandler.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <glad/gl.h>
+#include <string>
+#include <vector>
+
+/**
+ * @enum The passes timed by the GPU profiler
+*/
+enum GpuPass{
+    GPU_PASS_GENERATION,    // blades generation of the tiles entering the cache
+    GPU_PASS_WIND,          // wind texture of the frame
+    GPU_PASS_GEOMETRY,      // culling, compaction and draws into the gbuffer, without the generation
+    GPU_PASS_LIGHTING,
+    GPU_PASS_DEPTH_BLIT,
+    GPU_PASS_COUNT,
+};
+
+/**
+ * The times in ms of the passes of a frame
+*/
+struct GpuFrameTimes{
+    GLuint _Frame;      // index of the frame since the profiler's creation
+    std::array<float, GPU_PASS_COUNT> _Times;
+};
+
+/**
+ * Time the passes of the frames with timestamp queries
+ * Each frame in flight has its own queries, they are read a few frames later once the GPU is done with them,
+ * a frame whose results are still not available when its queries are reused is dropped rather than waited for
+*/
+class GpuProfiler{
+
+    public:
+        // frames in flight
+        static const GLuint _NB_FRAMES = 4;
+        // frames of the rolling statistics
+        static const GLuint _NB_SAMPLES = 240;
+
+    private:
+        // a begin and an end timestamp per pass
+        static const GLuint _NB_QUERIES = 2 * GPU_PASS_COUNT;
+
+        std::array<std::array<GLuint, _NB_QUERIES>, _NB_FRAMES> _Queries;
+        std::array<bool, _NB_FRAMES> _IsPending;
+        std::array<GLuint, _NB_FRAMES> _FrameIds;
+        GLuint _Current = 0;
+        GLuint _NbFrames = 0;
+        GLuint _NbDroppedFrames = 0;
+        // every frame read since the history was enabled, for the benchmarks
+        bool _KeepHistory = false;
+        std::vector<GpuFrameTimes> _History;
+        // newest frame read, until it is popped
+        GpuFrameTimes _LastFrame;
+        bool _HasNewFrame = false;
+
+        // times in ms of the last _NB_SAMPLES frames, _NextSample is the oldest one once the ring is full
+        std::array<std::vector<float>, GPU_PASS_COUNT> _Samples;
+        GLuint _NextSample = 0;
+        GLuint _NbSamples = 0;
+        std::array<std::array<float, 3>, GPU_PASS_COUNT> _Percentiles;
+        std::vector<float> _Sorted;
+
+    private:
+        GLuint getQuery(GpuPass pass, bool isEnd) const {
+            return _Queries[_Current][2 * pass + (isEnd ? 1 : 0)];
+        }
+
+        bool isAvailable(GLuint frame) const {
+            // the timestamps end in order, the last one is the last available
+            GLuint available = GL_FALSE;
+            glGetQueryObjectuiv(_Queries[frame][_NB_QUERIES - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+            return available == GL_TRUE;
+        }
+
+        void readResults(GLuint frame){
+            std::array<GLuint64, _NB_QUERIES> timestamps;
+            for(GLuint i=0; i<_NB_QUERIES; i++){
+                glGetQueryObjectui64v(_Queries[frame][i], GL_QUERY_RESULT, &timestamps[i]);
+            }
+            _IsPending[frame] = false;
+
+            std::array<float, GPU_PASS_COUNT> times;
+            for(int pass=0; pass<GPU_PASS_COUNT; pass++){
+                times[pass] = (timestamps[2 * pass + 1] - timestamps[2 * pass]) * 1e-6f;
+            }
+            // the generation is nested in the geometry pass
+            times[GPU_PASS_GEOMETRY] = std::max(0.f, times[GPU_PASS_GEOMETRY] - times[GPU_PASS_GENERATION]);
+            addSample(times);
+            _LastFrame = {_FrameIds[frame], times};
+            _HasNewFrame = true;
+            if(_KeepHistory){
+                _History.push_back({_FrameIds[frame], times});
+            }
+        }
+
+        void addSample(const std::array<float, GPU_PASS_COUNT>& times){
+            for(int pass=0; pass<GPU_PASS_COUNT; pass++){
+                _Samples[pass][_NextSample] = times[pass];
+            }
+            _NextSample = (_NextSample + 1) % _NB_SAMPLES;
+            if(_NbSamples < _NB_SAMPLES) _NbSamples++;
+
+            const float ranks[3] = {0.50f, 0.95f, 0.99f};
+            for(int pass=0; pass<GPU_PASS_COUNT; pass++){
+                _Sorted.assign(_Samples[pass].begin(), _Samples[pass].begin() + _NbSamples);
+                for(int i=0; i<3; i++){
+                    auto nth = _Sorted.begin() + GLuint(ranks[i] * (_NbSamples - 1));
+                    std::nth_element(_Sorted.begin(), nth, _Sorted.end());
+                    _Percentiles[pass][i] = *nth;
+                }
+            }
+        }
+
+    public:
+        GpuProfiler(){
+            for(auto& queries : _Queries){
+                glCreateQueries(GL_TIMESTAMP, _NB_QUERIES, queries.data());
+            }
+            _IsPending.fill(false);
+            _FrameIds.fill(0);
+            _LastFrame = {0, {}};
+            for(auto& samples : _Samples){
+                samples.assign(_NB_SAMPLES, 0.f);
+            }
+            for(auto& percentiles : _Percentiles){
+                percentiles.fill(0.f);
+            }
+            _Sorted.reserve(_NB_SAMPLES);
+        }
+
+        ~GpuProfiler(){
+            for(auto& queries : _Queries){
+                glDeleteQueries(_NB_QUERIES, queries.data());
+            }
+        }
+
+        GpuProfiler(const GpuProfiler&) = delete;
+        GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+        /**
+         * Start the frame, every pass must be timed once before its end
+        */
+        void beginFrame(){
+            if(_IsPending[_Current]){
+                if(isAvailable(_Current)){
+                    readResults(_Current);
+                } else {
+                    _IsPending[_Current] = false;
+                    _NbDroppedFrames++;
+                }
+            }
+        }
+
+        void begin(GpuPass pass){
+            glQueryCounter(getQuery(pass, false), GL_TIMESTAMP);
+        }
+
+        void end(GpuPass pass){
+            glQueryCounter(getQuery(pass, true), GL_TIMESTAMP);
+        }
+
+        /**
+         * End the frame and read the oldest frame if the GPU is done with it
+        */
+        void endFrame(){
+            _IsPending[_Current] = true;
+            _FrameIds[_Current] = _NbFrames++;
+            _Current = (_Current + 1) % _NB_FRAMES;
+            if(_IsPending[_Current] && isAvailable(_Current)){
+                readResults(_Current);
+            }
+        }
+
+        /**
+         * Wait for the GPU and read every pending frame
+        */
+        void flush(){
+            for(GLuint i=0; i<_NB_FRAMES; i++){
+                GLuint frame = (_Current + i) % _NB_FRAMES;
+                if(_IsPending[frame]) readResults(frame);
+            }
+        }
+
+        /**
+         * Keep the times of every frame read from now on
+         * @param keepHistory False to stop and clear the history
+        */
+        void setKeepHistory(bool keepHistory){
+            _KeepHistory = keepHistory;
+            _History.clear();
+        }
+
+        /**
+         * Get the frames read since the history was enabled, in the order they were rendered, without the dropped ones
+        */
+        const std::vector<GpuFrameTimes>& getHistory() const {
+            return _History;
+        }
+
+        /**
+         * Get the newest frame read since the last call, once
+         * @param times The times of the frame
+         * @return False if no frame was read since the last call, times is left as is
+        */
+        bool popFrameTimes(GpuFrameTimes& times){
+            if(!_HasNewFrame) return false;
+            times = _LastFrame;
+            _HasNewFrame = false;
+            return true;
+        }
+
+        static const char* getPassName(GpuPass pass){
+            switch(pass){
+                case GPU_PASS_GENERATION: return "Generation";
+                case GPU_PASS_WIND: return "Wind";
+                case GPU_PASS_GEOMETRY: return "Geometry";
+                case GPU_PASS_LIGHTING: return "Lighting";
+                case GPU_PASS_DEPTH_BLIT: return "Depth blit";
+                default: return "";
+            }
+        }
+
+        /**
+         * Get the rolling times of a pass, a ring starting at getSamplesOffset once full
+         * @param pass The pass
+        */
+        const std::vector<float>& getSamples(GpuPass pass) const {
+            return _Samples[pass];
+        }
+
+        GLuint getSamplesOffset() const {
+            return _NbSamples < _NB_SAMPLES ? 0 : _NextSample;
+        }
+
+        GLuint getNbSamples() const {
+            return _NbSamples;
+        }
+
+        GLuint getNbDroppedFrames() const {
+            return _NbDroppedFrames;
+        }
+
+        float getP50(GpuPass pass) const {return _Percentiles[pass][0];}
+        float getP95(GpuPass pass) const {return _Percentiles[pass][1];}
+        float getP99(GpuPass pass) const {return _Percentiles[pass][2];}
+
+        /**
+         * Write the rolling times of every pass, from the oldest frame
+         * @param path The path of the csv file
+         * @return False if the file can't be written
+        */
+        bool exportCSV(const std::string& path) const {
+            FILE* file = fopen(path.c_str(), "w");
+            if(file == nullptr){
+                fprintf(stderr, "Failed to write the GPU profile: %s!\n", path.c_str());
+                ErrorHandler::handle(ErrorCodes::IO_ERROR, ErrorLevel::WARNING);
+                return false;
+            }
+            fprintf(file, "frame");
+            for(int pass=0; pass<GPU_PASS_COUNT; pass++){
+                fprintf(file, ",%s (ms)", getPassName(GpuPass(pass)));
+            }
+            fprintf(file, "\n");
+            GLuint offset = getSamplesOffset();
+            for(GLuint i=0; i<_NbSamples; i++){
+                fprintf(file, "%u", i);
+                for(int pass=0; pass<GPU_PASS_COUNT; pass++){
+                    fprintf(file, ",%.4f", _Samples[pass][(offset + i) % _NB_SAMPLES]);
+                }
+                fprintf(file, "\n");
+            }
+            fclose(file);
+            fprintf(stdout, "GPU profile written to %s\n", path.c_str());
+            return true;
+        }
+};
@@ -7,123 +7,168 @@
 #include "shaders.hpp"
 #include "utils.hpp"
 #include <GL/glu.h>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
 #include <cstdlib>
 #include <array>
 
 void Grass::initBuffers(){
+    // the draws are attributeless, the shaders pull the blades
     glCreateVertexArrays(1, &_VAO);
-    // Generate buffer objects
-    glCreateBuffers(1, &_PositionBuffer);
-    glCreateBuffers(1, &_HeightBuffer);
-    glCreateBuffers(1, &_WidthBuffer);
-    glCreateBuffers(1, &_ColorBuffer);
-    glCreateBuffers(1, &_RotationBuffer);
-    glCreateBuffers(1, &_TiltBuffer);
-    glCreateBuffers(1, &_BendBuffer);
-
-    // Set up buffers
-    // positions
-    glNamedBufferStorage(_PositionBuffer, 
-        GRASS_POSITION_BUFFER_ELEMENT_SIZE * _MAX_NB_GRASS_BLADES * _NB_PARALLEL_BUFFERS,
-        nullptr, GL_DYNAMIC_STORAGE_BIT
-    );
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, _PositionBuffer);
 
-    // heights
-    glNamedBufferStorage(_HeightBuffer, 
-        GRASS_HEIGHT_BUFFER_ELEMENT_SIZE * _MAX_NB_GRASS_BLADES * _NB_PARALLEL_BUFFERS, 
-        nullptr, GL_DYNAMIC_STORAGE_BIT
-    );
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, _HeightBuffer);
+    // the cpu generation writes the blades straight into the grass buffers
+    GLbitfield mapFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    GLbitfield storageFlags = GL_DYNAMIC_STORAGE_BIT;
+    if(_Generation == GRASS_GENERATION_CPU){
+        storageFlags |= mapFlags;
+    }
 
-    // widths
-    glNamedBufferStorage(_WidthBuffer, 
-        GRASS_WIDTH_BUFFER_ELEMENT_SIZE * _MAX_NB_GRASS_BLADES * _NB_PARALLEL_BUFFERS, 
-        nullptr, GL_DYNAMIC_STORAGE_BIT
-    );
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, _WidthBuffer);
+    // blades
+    GLsizeiptr bladesSize = sizeof(GrassBlade) * _MAX_NB_GRASS_BLADES * _NB_PARALLEL_BUFFERS;
+    glCreateBuffers(1, &_BladeBuffer);
+    glNamedBufferStorage(_BladeBuffer, bladesSize, nullptr, storageFlags);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, _BladeBuffer);
+
+    // clumps
+    GLsizeiptr clumpsSize = sizeof(GrassClump) * _MAX_NB_CLUMPS * _NB_PARALLEL_BUFFERS;
+    glCreateBuffers(1, &_ClumpBuffer);
+    glNamedBufferStorage(_ClumpBuffer, clumpsSize, nullptr, storageFlags);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, _ClumpBuffer);
+
+    if(_Generation == GRASS_GENERATION_CPU){
+        _MappedBlades = (GrassBlade*)glMapNamedBufferRange(_BladeBuffer, 0, bladesSize, mapFlags);
+        _MappedClumps = (GrassClump*)glMapNamedBufferRange(_ClumpBuffer, 0, clumpsSize, mapFlags);
+        if(_MappedBlades == nullptr || _MappedClumps == nullptr){
+            fprintf(stderr, "Failed to map the grass buffers!\n");
+            ErrorHandler::handle(ErrorCodes::GL_ERROR);
+        }
+    }
 
-    // colors
-    glNamedBufferStorage(_ColorBuffer, 
-        GRASS_COLOR_BUFFER_ELEMENT_SIZE * _MAX_NB_GRASS_BLADES * _NB_PARALLEL_BUFFERS,
+    // indirect draws
+    glCreateBuffers(1, &_IndirectBuffer);
+    glNamedBufferStorage(_IndirectBuffer, 
+        sizeof(DrawArraysIndirectCommand) * _NB_PARALLEL_BUFFERS, 
         nullptr, GL_DYNAMIC_STORAGE_BIT
     );
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, _ColorBuffer);
-
-    // rotations
-    glNamedBufferStorage(_RotationBuffer, 
-        GRASS_ROTATION_BUFFER_ELEMENT_SIZE * _MAX_NB_GRASS_BLADES * _NB_PARALLEL_BUFFERS, 
+    glCreateBuffers(1, &_DrawInfoBuffer);
+    glNamedBufferStorage(_DrawInfoBuffer, 
+        sizeof(GrassDrawInfo) * _NB_PARALLEL_BUFFERS, 
         nullptr, GL_DYNAMIC_STORAGE_BIT
     );
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, _RotationBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, _DrawInfoBuffer);
 
-    // tilt
-    glNamedBufferStorage(_TiltBuffer, 
-        GRASS_TILT_BUFFER_ELEMENT_SIZE * _MAX_NB_GRASS_BLADES * _NB_PARALLEL_BUFFERS, 
-        nullptr, GL_DYNAMIC_STORAGE_BIT
+    ErrorHandler::checkGLError("Failed to initialize the grass buffers!");
+    
+}
+
+void Grass::initCullingBuffers(){
+    _CullShader = ShaderRegistry::getComputeShader("shader/grassCull.glsl");
+
+    // tiles bounding boxes, indexed by tile id
+    std::vector<GrassTileBounds> bounds;
+    for(auto& tile : _Tiles){
+        bounds.push_back({glm::vec4(tile->getBoundsMin(), 1.f), glm::vec4(tile->getBoundsMax(), 1.f)});
+    }
+    glCreateBuffers(1, &_TileBoundsBuffer);
+    glNamedBufferStorage(_TileBoundsBuffer, 
+        sizeof(GrassTileBounds) * bounds.size(), 
+        bounds.data(), 0
     );
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, _TiltBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 8, _TileBoundsBuffer);
+
+    // tile of each slot
+    std::vector<GLint> slotTiles(_NB_PARALLEL_BUFFERS, -1);
+    glCreateBuffers(1, &_SlotTilesBuffer);
+    glNamedBufferStorage(_SlotTilesBuffer, 
+        sizeof(GLint) * _NB_PARALLEL_BUFFERS, 
+        slotTiles.data(), GL_DYNAMIC_STORAGE_BIT
+    );
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 9, _SlotTilesBuffer);
+
+    // draw counters, read back by the triangle budget
+    GrassCullCounters counters = {0, 0, 0, 0, 0};
+    glCreateBuffers(1, &_CullCountersBuffer);
+    glNamedBufferStorage(_CullCountersBuffer, 
+        sizeof(GrassCullCounters), 
+        &counters, GL_DYNAMIC_STORAGE_BIT
+    );
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 10, _CullCountersBuffer);
 
-    // bend
-    glNamedBufferStorage(_BendBuffer, 
-        GRASS_BEND_BUFFER_ELEMENT_SIZE * _MAX_NB_GRASS_BLADES * _NB_PARALLEL_BUFFERS, 
-        nullptr, GL_DYNAMIC_STORAGE_BIT
+    // the culling shader writes the indirect commands
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 11, _IndirectBuffer);
+
+    // visible blades of each draw
+    _CompactShader = ShaderRegistry::getComputeShader("shader/grassCompact.glsl");
+    glCreateBuffers(1, &_VisibleBladesBuffer);
+    glNamedBufferStorage(_VisibleBladesBuffer, 
+        sizeof(GLuint) * _MAX_NB_GRASS_BLADES * _NB_PARALLEL_BUFFERS, 
+        nullptr, 0
     );
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, _BendBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 13, _VisibleBladesBuffer);
 
-    auto error = glGetError();
-    if (error != GL_NO_ERROR) {
-        fprintf(stderr, "Failed to initialize the grass buffers!\n\tOpenGL error: %s\n", gluErrorString(error));
-        ErrorHandler::handle(ErrorCodes::GL_ERROR);
+    ErrorHandler::checkGLError("Failed to initialize the culling buffers!");
+}
+
+void Grass::initTileParamsBuffer(){
+    std::vector<GrassTileParams> params;
+    for(auto& tile : _Tiles){
+        params.push_back({
+            tile->_TilePos,
+            (GLint)tile->_TileWidth, (GLint)tile->_TileHeight,
+            (GLint)tile->_GridNbCols, (GLint)tile->_GridNbLines,
+            (GLint)tile->_TileId, 0
+        });
     }
-    
+    glCreateBuffers(1, &_TileParamsBuffer);
+    glNamedBufferStorage(_TileParamsBuffer, 
+        sizeof(GrassTileParams) * params.size(), 
+        params.data(), 0
+    );
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 14, _TileParamsBuffer);
+
+    // the tiles share the program, its constants are only set once
+    const ComputeShaderPointer& shader = _Tiles.front()->_ComputeShader;
+    shader->setInt("nbBladesPerTile", _MAX_NB_GRASS_BLADES);
+    shader->setInt("nbClumpsPerTile", _MAX_NB_CLUMPS);
+
+    ErrorHandler::checkGLError("Failed to initialize the tile params buffer!");
 }
 
 void GrassTile::initShader(const std::string& shaderPath){
-    _ComputeShader = new ComputeShader(shaderPath);
+    _ComputeShader = ShaderRegistry::getComputeShader(shaderPath);
 
-    auto error = glGetError();
-    if (error != GL_NO_ERROR) {
-        fprintf(stderr, "Failed to initialize the grass shaders!\n\tOpenGL error: %s\n", gluErrorString(error));
-        ErrorHandler::handle(ErrorCodes::GL_ERROR);
-    }
+    ErrorHandler::checkGLError("Failed to initialize the grass shaders!");
 }
 
 GrassTile::GrassTile(
     const glm::vec2& tilePos,
     GLuint tileWidth, GLuint tileHeight,
-    GrassLOD tileLOD,
     const std::string& shaderPath){
     // initBuffers();
     initShader(shaderPath);
     // updateRenderingBuffers();
     _TilePos = tilePos;
-    _LOD = tileLOD;
     _TileHeight = tileHeight;
     _TileWidth = tileWidth;
 }
 
 
-void GrassTile::dispatchComputeShader(int parallelId, GLuint vao){
+void GrassTile::dispatchComputeShader(GLuint tileIndex, int parallelId, GLuint vao){
     // Bind the compute shader program
     auto& shader = _ComputeShader;
     shader->use();
     glBindVertexArray(vao);
 
-    // _ComputeShader->setInt("nbGrassBlades", _NbGrassBlades);
-    shader->setInt("tileWidth", _TileWidth);
-    shader->setInt("tileHeight", _TileHeight);
-    shader->setInt("gridNbCols", _GridNbCols);
-    shader->setInt("gridNbLines", _GridNbLines);
-    shader->setVec2f("tilePos", _TilePos);
-    shader->setInt("tileID", (int)_TileId);
+    // the tile's parameters are in the tile params buffer
+    shader->setInt("tileIndex", tileIndex);
     shader->setInt("parallelId", parallelId);
-    shader->setInt("nbBladesPerTile", _MAX_NB_GRASS_BLADES);
 
     // Dispatch the compute shader
 
     // Set your initial dispatch values
-    int dispatchX = _NbGrassBlades;
+    // the whole tile is generated so its cache slot stays valid whatever the lod
+    int dispatchX = _MAX_NB_GRASS_BLADES;
     int dispatchY = 1;
     int dispatchZ = 1;
 
@@ -151,72 +196,6 @@ void GrassTile::dispatchComputeShader(int parallelId, GLuint vao){
     // printBuffers();
 }
 
-void Grass::updateRenderingBuffers(){
-    auto error = glGetError();
-
-    // positions
-    glEnableVertexArrayAttrib(_VAO, 0);
-    glVertexArrayAttribFormat(_VAO, 0, GRASS_POSITION_NB_ELEMENT, GL_FLOAT, GL_FALSE, 0);
-    glVertexArrayAttribBinding(_VAO, 0, 0);
-    glVertexArrayVertexBuffer(_VAO, 0, _PositionBuffer, 0, GRASS_POSITION_BUFFER_ELEMENT_SIZE);
-
-    // heights
-    glEnableVertexArrayAttrib(_VAO, 1);
-    glVertexArrayAttribFormat(_VAO, 1, GRASS_HEIGHT_NB_ELEMENT, GL_FLOAT, GL_FALSE, 0);
-    glVertexArrayAttribBinding(_VAO, 1, 1);
-    glVertexArrayVertexBuffer(_VAO, 1, _HeightBuffer, 0, GRASS_HEIGHT_BUFFER_ELEMENT_SIZE);
-
-    // widths
-    glEnableVertexArrayAttrib(_VAO, 2);
-    glVertexArrayAttribFormat(_VAO, 2, GRASS_WIDTH_NB_ELEMENT, GL_FLOAT, GL_FALSE, 0);
-    glVertexArrayAttribBinding(_VAO, 2, 2);
-    glVertexArrayVertexBuffer(_VAO, 2, _WidthBuffer, 0, GRASS_WIDTH_BUFFER_ELEMENT_SIZE);
-
-    // colors
-    glEnableVertexArrayAttrib(_VAO, 3);
-    glVertexArrayAttribFormat(_VAO, 3, GRASS_COLOR_NB_ELEMENT, GL_FLOAT, GL_FALSE, 0);
-    glVertexArrayAttribBinding(_VAO, 3, 3);
-    glVertexArrayVertexBuffer(_VAO, 3, _ColorBuffer, 0, GRASS_COLOR_BUFFER_ELEMENT_SIZE);
-
-    // rotations
-    glEnableVertexArrayAttrib(_VAO, 4);
-    glVertexArrayAttribFormat(_VAO, 4, GRASS_ROTATION_NB_ELEMENT, GL_FLOAT, GL_FALSE, 0);
-    glVertexArrayAttribBinding(_VAO, 4, 4);
-    glVertexArrayVertexBuffer(_VAO, 4, _RotationBuffer, 0, GRASS_ROTATION_BUFFER_ELEMENT_SIZE);
-
-    // tilt
-    glEnableVertexArrayAttrib(_VAO, 5);
-    glVertexArrayAttribFormat(_VAO, 5, GRASS_TILT_NB_ELEMENT, GL_FLOAT, GL_FALSE, 0);
-    glVertexArrayAttribBinding(_VAO, 5, 5);
-    glVertexArrayVertexBuffer(_VAO, 5, _TiltBuffer, 0, GRASS_TILT_BUFFER_ELEMENT_SIZE);
-
-    // bend
-    glEnableVertexArrayAttrib(_VAO, 6);
-    glVertexArrayAttribFormat(_VAO, 6, GRASS_BEND_NB_ELEMENT, GL_FLOAT, GL_FALSE, 0);
-    glVertexArrayAttribBinding(_VAO, 6, 6);
-    glVertexArrayVertexBuffer(_VAO, 6, _BendBuffer, 0, GRASS_BEND_BUFFER_ELEMENT_SIZE);
-    
-    error = glGetError();
-    if (error != GL_NO_ERROR) {
-        fprintf(stderr, "Failed to update the grass buffers!\n\tOpenGL error: %s\n", gluErrorString(error));
-        ErrorHandler::handle(ErrorCodes::GL_ERROR);
-    }
-}
-
-void GrassTile::render(Shaders* shaders, float time, GLuint vao){
-    // Bind the vertex array object and draw
-    shaders->use();
-    glBindVertexArray(vao);
-    shaders->setInt("tileLOD", _LOD);
-    shaders->setFloat("time", time);
-    // shaders->setInt("nbParallelBuffers", _NbParallelBuffers);
-    // shaders->setInt("nbBladesPerTile", _NbGrassBlades);
-    // shaders->setInt("tileWidth", tileWidth);
-    // shaders->setInt("tileHeight", tileHeight);
-    // glDrawArraysInstanced(GL_POINTS, 0, 1, _NbGrassBlades);
-    glDrawArrays(GL_POINTS, 0, _NbGrassBlades);
-}
-
 // void GrassTile::render(Shaders* shaders, float time, int nbGrassBlades, GLuint vao){
 //     // Bind the vertex array object and draw
 //     shaders->use();
@@ -234,17 +213,26 @@ GLint GrassTile::_MaxWorkGroupCountX = 0;
 GLint GrassTile::_MaxWorkGroupCountY = 0;
 GLint GrassTile::_MaxWorkGroupCountZ = 0;
 
-Grass::Grass(){
+Grass::Grass(GrassGeneration generation) : _Generation(generation){
     glm::vec2 curPos = glm::vec2();
     _Material = MaterialPointer(new Material());
     GLuint nbTiles = _NbTileLength*_NbTileLength;
 
     initBuffers();
-    updateRenderingBuffers();
 
     initLightShader();
 
+    // past the window of the wind texture the blades would sample the wind of the other side
+    if(_MaxRadiusRender + _MAX_BLADE_REACH > WindField::getMaxDistance()){
+        fprintf(stderr, "The wind texture covers %.2f m around the camera, the blades reach %.2f m!\n",
+            WindField::getMaxDistance(), _MaxRadiusRender + _MAX_BLADE_REACH);
+        ErrorHandler::handle(ErrorCodes::BAD_VALUE);
+    }
+
     float totalWidth = _NbTileLength * _TileWidth;
+    std::vector<glm::vec3> minCorners;
+    std::vector<glm::vec3> maxCorners;
+    _TilePool.reserve(nbTiles);
     curPos.x = 0.f;
     curPos.y = -1.f * _TileHeight;
     for(GLuint i = 0; i < nbTiles; i++){
@@ -255,8 +243,15 @@ Grass::Grass(){
             curPos.y += 1.f * _TileHeight;
         }
         // std::cout << "pos: " << curPos.x << ", " << curPos.y << std::endl;
-        _Tiles.push_back(new GrassTile(curPos, _TileWidth, _TileHeight));
+        _TilePool.emplace_back(curPos, _TileWidth, _TileHeight);
+        _Tiles.push_back(&_TilePool.back());
+        _Tiles.back()->_RadiusRender = _RadiusRender;
+        minCorners.push_back(_Tiles.back()->getBoundsMin());
+        maxCorners.push_back(_Tiles.back()->getBoundsMax());
     }
+    _TileQuadtree.build(_NbTileLength, _NbTileLength, minCorners, maxCorners);
+    initTileParamsBuffer();
+    initCullingBuffers();
 
     // get max work group values
     glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_COUNT, 0, &GrassTile::_MaxWorkGroupCountX);
@@ -264,32 +259,42 @@ Grass::Grass(){
     glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_COUNT, 2, &GrassTile::_MaxWorkGroupCountZ);
 }
 
-void Grass::renderBatch(Shaders* shaders, float time, 
-    const std::array<GrassLOD, _NB_PARALLEL_BUFFERS>& lods, 
-    const std::array<int, _NB_PARALLEL_BUFFERS>&  nbBlades
-    ){
+void Grass::renderBatch(Shaders* shaders, const std::array<int, _NB_PARALLEL_BUFFERS>&  nbBlades){
+    // one command per visible slot, with the tile in the slot as on the gpu culling
+    const std::vector<GLint>& slotTiles = _BladeCache.getSlotTiles();
+    GLuint nbCommands = 0;
+    for(int i=0; i<_NB_PARALLEL_BUFFERS; i++){
+        if(nbBlades[i] == 0) continue;
+        _DrawCommands[nbCommands] = getEmptyCommand();
+        _DrawInfos[nbCommands] = {i*_MAX_NB_GRASS_BLADES, (GLuint)slotTiles[i], (GLuint)nbBlades[i]};
+        nbCommands++;
+    }
+    GrassCullCounters counters = {(_MaxNbBlades + 63) / 64, nbCommands, 1, 0, 0};
+    glNamedBufferSubData(_IndirectBuffer, 0, nbCommands * sizeof(DrawArraysIndirectCommand), _DrawCommands.data());
+    glNamedBufferSubData(_DrawInfoBuffer, 0, nbCommands * sizeof(GrassDrawInfo), _DrawInfos.data());
+    glNamedBufferSubData(_CullCountersBuffer, 0, sizeof(GrassCullCounters), &counters);
+    compactBlades();
+
     shaders->use();
     glBindVertexArray(_VAO);
-    shaders->setFloat("time", time);
-    // shaders->setInt("nbBlades0", nbBlades[0]);
-    // shaders->setInt("nbBlades1", nbBlades[1]);
-    for(int i=0; i<_NB_PARALLEL_BUFFERS; i++){        
-        int blades = nbBlades[i];
-        int startId = i*_MAX_NB_GRASS_BLADES;
-        if(blades == 0) continue;
-        shaders->setInt("tileLOD", lods[i]);
-        shaders->setInt("startId", startId);
-        // shaders->setInt("nbBladesPerTile", _MAX_NB_GRASS_BLADES);
-        glDrawArrays(GL_POINTS, 0, blades);
-    }
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _IndirectBuffer);
+    glMultiDrawArraysIndirect(getDrawMode(), nullptr, nbCommands, 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
 }
 
 void Grass::render(Shaders* shaders, const Camera* camera, const glm::mat4& view, const glm::mat4& proj){
+    _Profiler.beginFrame();
+    // the wind of the frame, the frame uniforms are up to date
+    _Profiler.begin(GPU_PASS_WIND);
+    _Wind.update();
+    _Profiler.end(GPU_PASS_WIND);
     // Pass 1 - geometry
+    _Profiler.begin(GPU_PASS_GEOMETRY);
     glBindFramebuffer(GL_FRAMEBUFFER, _Gbuffer);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    shaders->setMat4f("proj", proj);
-    shaders->setMat4f("view", view);
+    // view, proj, camPos and time are in the frame uniforms
+    updateBudget(proj);
+    shaders->setFloat("segmentScale", _SegmentScale);
 
     glm::mat4 mvp = proj * view;
     // _Material->setShaderValues(shaders);
@@ -303,58 +308,303 @@ void Grass::render(Shaders* shaders, const Camera* camera, const glm::mat4& view
     //     }
     // }
 
-    for(int i=0; i<_Tiles.size(); i+=_NB_PARALLEL_BUFFERS){
-        std::array<int, _NB_PARALLEL_BUFFERS> nbBlades;
-        std::array<GrassLOD, _NB_PARALLEL_BUFFERS> lods;
-        bool shouldBeRendered = false;
-        // #pragma omp parallel for
-        for(int j = 0; j<_NB_PARALLEL_BUFFERS; j++){
-            auto& tile = _Tiles[i+j];
-            if(tile->shouldBeRendered(camera->getPosition(), frustum)){
-                tile->dispatchComputeShader(j, _VAO);
-                // tile->render(shaders, _TotalTime, j, _VAO);
-                nbBlades[j] = (tile->_NbGrassBlades);
-                lods[j] = (tile->_LOD);
-                shouldBeRendered = true;
-            } else {
-                nbBlades[j] = 0;
-                lods[j] = tile->_LOD;
+    _BladeCache.newFrame();
+    switch(_Culling){
+        case GRASS_CULLING_CPU:
+            renderCulledOnCPU(shaders, camera->getPosition(), frustum);
+            break;
+        case GRASS_CULLING_GPU:
+            renderCulledOnGPU(shaders, camera->getPosition());
+            break;
+    }
+    // the counters are read back once the GPU is done with the frame
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    _CountersReadback.copy(_CullCountersBuffer, offsetof(GrassCullCounters, _NbTriangles));
+    if(_Generation == GRASS_GENERATION_CPU){
+        glDeleteSync(_FrameFence);
+        _FrameFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+    _Profiler.end(GPU_PASS_GEOMETRY);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, _OutputFramebuffer);
+    // Pass 2 - lighting
+    lightShaderPass();
+    _Profiler.endFrame();
+}
+
+void Grass::renderCulledOnCPU(Shaders* shaders, const glm::vec3& cameraPosition, const Frustum& frustum){
+    _TileQuadtree.evaluate(cameraPosition, frustum, _RadiusRender, _MaxNbBlades, _MIN_NB_GRASS_BLADES);
+    const TileArrays& arrays = _TileQuadtree.getArrays();
+
+    // free the tiles that left the render radius, the quadtree only evaluates the tiles within it
+    const std::vector<GLint>& slotTiles = _BladeCache.getSlotTiles();
+    for(GLuint slot=0; slot<slotTiles.size(); slot++){
+        if(slotTiles[slot] == -1) continue;
+        if(!getTile(slotTiles[slot])->isWithinRenderRadius(cameraPosition)){
+            _BladeCache.release(slotTiles[slot]);
+        }
+    }
+
+    // the blades of a tile are only generated when it enters the cache
+    _Profiler.begin(GPU_PASS_GENERATION);
+    std::array<int, _NB_PARALLEL_BUFFERS> nbBlades;
+    nbBlades.fill(0);
+    bool shouldBeRendered = false;
+    bool hasMisses = false;
+    for(GLuint i : arrays._VisibleTiles){
+        GrassTile* tile = _Tiles[arrays._TileIndices[i]];
+        GLuint slot = 0;
+        bool isHit = false;
+        if(!_BladeCache.getSlot(tile->_TileId, slot, isHit)) continue;
+        if(!isHit){
+            generateBlades(tile, slot);
+            hasMisses = true;
+        }
+        nbBlades[slot] = arrays._NbBlades[i];
+        shouldBeRendered = true;
+    }
+    if(hasMisses){
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    }
+    _Profiler.end(GPU_PASS_GENERATION);
+    if(shouldBeRendered){
+        renderBatch(shaders, nbBlades);
+    }
+}
+
+void Grass::renderCulledOnGPU(Shaders* shaders, const glm::vec3& cameraPosition){
+    updateResidency(cameraPosition);
+    cullTiles();
+    compactBlades();
+    renderIndirect(shaders);
+}
+
+void Grass::updateResidency(const glm::vec3& cameraPosition){
+    bool slotsChanged = false;
+
+    // free the tiles that left the render radius
+    const std::vector<GLint>& slotTiles = _BladeCache.getSlotTiles();
+    for(GLuint slot=0; slot<slotTiles.size(); slot++){
+        if(slotTiles[slot] == -1) continue;
+        GrassTile* tile = getTile(slotTiles[slot]);
+        if(!tile->isWithinRenderRadius(cameraPosition)){
+            slotsChanged |= _BladeCache.release(tile->_TileId);
+        }
+    }
+
+    // only the tiles around the camera can be within the render radius, their blades reach past them
+    float reach = _RadiusRender + _MAX_BLADE_REACH;
+    int minCol = std::max(0, (int)std::floor((cameraPosition.x - reach) / _TileWidth));
+    int maxCol = std::min((int)_NbTileLength - 1, (int)std::floor((cameraPosition.x + reach) / _TileWidth));
+    int minLine = std::max(0, (int)std::floor((cameraPosition.z - reach) / _TileHeight));
+    int maxLine = std::min((int)_NbTileLength - 1, (int)std::floor((cameraPosition.z + reach) / _TileHeight));
+
+    _Profiler.begin(GPU_PASS_GENERATION);
+    bool hasMisses = false;
+    for(int line=minLine; line<=maxLine; line++){
+        for(int col=minCol; col<=maxCol; col++){
+            GrassTile* tile = _Tiles[line*_NbTileLength + col];
+            if(!tile->isWithinRenderRadius(cameraPosition)) continue;
+            GLuint slot = 0;
+            bool isHit = false;
+            if(!_BladeCache.getSlot(tile->_TileId, slot, isHit)) continue;
+            if(!isHit){
+                generateBlades(tile, slot);
+                hasMisses = true;
             }
         }
+    }
+    if(hasMisses){
         glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
-        if(shouldBeRendered){
-            renderBatch(shaders, _TotalTime, lods, nbBlades);
+    }
+    _Profiler.end(GPU_PASS_GENERATION);
+
+    if(slotsChanged || hasMisses){
+        glNamedBufferSubData(_SlotTilesBuffer, 0, sizeof(GLint) * slotTiles.size(), slotTiles.data());
+    }
+}
+
+void Grass::generateBlades(GrassTile* tile, GLuint slot){
+    if(_Generation == GRASS_GENERATION_GPU){
+        tile->dispatchComputeShader(tile->_TileId - _Tiles.front()->_TileId, slot, _VAO);
+        return;
+    }
+    // the evicted slot may still be read by the previous frame
+    waitFrameFence();
+    BladeGenerator generator(tile->_TileWidth, tile->_TileHeight, tile->_GridNbCols, tile->_GridNbLines);
+    generator.generate(tile->_TilePos, tile->_TileId, slot * _MAX_NB_CLUMPS, _MAX_NB_GRASS_BLADES,
+        _MappedBlades + slot * _MAX_NB_GRASS_BLADES,
+        _MappedClumps + slot * _MAX_NB_CLUMPS
+    );
+}
+
+// distance between the 16 low bits of two packed values, in ulps for two positive half floats
+static GLuint getLowBitsDistance(GLuint a, GLuint b){
+    GLint distance = GLint(a & 0xffff) - GLint(b & 0xffff);
+    return distance < 0 ? -distance : distance;
+}
+
+bool Grass::verifyGeneration(){
+    const GLuint maxHalfDistance = 2;
+    const GLuint maxAngleDistance = 1;
+    const float maxColorDistance = 1e-5f;
+    const GLuint maxReported = 8;
+
+    // the first slot, nothing is cached yet
+    GrassTile* tile = _Tiles.front();
+    tile->dispatchComputeShader(0, 0, _VAO);
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    std::vector<GrassBlade> gpuBlades(_MAX_NB_GRASS_BLADES);
+    std::vector<GrassClump> gpuClumps(_MAX_NB_CLUMPS);
+    glGetNamedBufferSubData(_BladeBuffer, 0, sizeof(GrassBlade) * gpuBlades.size(), gpuBlades.data());
+    glGetNamedBufferSubData(_ClumpBuffer, 0, sizeof(GrassClump) * gpuClumps.size(), gpuClumps.data());
+    ErrorHandler::checkGLError("Failed to read back the generated tile!");
+
+    BladeGenerator generator(tile->_TileWidth, tile->_TileHeight, tile->_GridNbCols, tile->_GridNbLines);
+    std::vector<GrassBlade> cpuBlades(_MAX_NB_GRASS_BLADES);
+    std::vector<GrassClump> cpuClumps(generator.getNbClumps());
+    generator.generate(tile->_TilePos, tile->_TileId, 0, _MAX_NB_GRASS_BLADES, cpuBlades.data(), cpuClumps.data());
+
+    GLuint nbBladeErrors = 0;
+    for(GLuint i=0; i<_MAX_NB_GRASS_BLADES; i++){
+        const GrassBlade& gpu = gpuBlades[i];
+        const GrassBlade& cpu = cpuBlades[i];
+        GLuint angleDistance = getLowBitsDistance(gpu._BendYRotation >> 16, cpu._BendYRotation >> 16);
+        angleDistance = std::min(angleDistance, 0x10000 - angleDistance);
+        bool isEqual = gpu._PosX == cpu._PosX && gpu._PosZ == cpu._PosZ && gpu._Clump == cpu._Clump
+            && getLowBitsDistance(gpu._HeightWidth, cpu._HeightWidth) <= maxHalfDistance
+            && getLowBitsDistance(gpu._HeightWidth >> 16, cpu._HeightWidth >> 16) <= maxHalfDistance
+            && getLowBitsDistance(gpu._TiltBendX, cpu._TiltBendX) <= maxHalfDistance
+            && getLowBitsDistance(gpu._TiltBendX >> 16, cpu._TiltBendX >> 16) <= maxHalfDistance
+            && getLowBitsDistance(gpu._BendYRotation, cpu._BendYRotation) <= maxHalfDistance
+            && angleDistance <= maxAngleDistance;
+        if(isEqual) continue;
+        if(nbBladeErrors++ < maxReported){
+            fprintf(stderr, "Blade %u: gpu (%f, %f) clump %u height %f rotation %f, cpu (%f, %f) clump %u height %f rotation %f\n",
+                i, gpu._PosX, gpu._PosZ, gpu._Clump, gpu.getHeight(), gpu.getRotation(),
+                cpu._PosX, cpu._PosZ, cpu._Clump, cpu.getHeight(), cpu.getRotation());
         }
     }
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    // Pass 2 - lighting
-    lightShaderPass();
+    GLuint nbClumpErrors = 0;
+    for(GLuint i=0; i<cpuClumps.size(); i++){
+        glm::vec4 difference = glm::abs(gpuClumps[i]._Color - cpuClumps[i]._Color);
+        if(glm::max(glm::max(difference.x, difference.y), glm::max(difference.z, difference.w)) <= maxColorDistance) continue;
+        if(nbClumpErrors++ < maxReported){
+            fprintf(stderr, "Clump %u: gpu green %f, cpu green %f\n", i, gpuClumps[i]._Color.y, cpuClumps[i]._Color.y);
+        }
+    }
+
+    fprintf(stdout, "Generation of tile %u: %u/%u blades and %u/%u clumps differ\n", tile->_TileId,
+        nbBladeErrors, _MAX_NB_GRASS_BLADES, nbClumpErrors, GLuint(cpuClumps.size()));
+    return nbBladeErrors == 0 && nbClumpErrors == 0;
 }
 
-void Grass::update(float dt, const glm::vec3& cameraPosition){
-    _TotalTime += dt;
-    // update tiles lod
-    for(auto& tile : _Tiles){
-        // get tile's position
-        glm::vec3 tileUpLeft = tile->getPos();
-        glm::vec3 tileUpRight = tile->getPos() + glm::vec3(_TileWidth, 0.f, 0.f);
-        glm::vec3 tileDownLeft = tile->getPos() + glm::vec3(0.f, 0.f, _TileHeight);
-        glm::vec3 tileDownRight = tile->getPos() + glm::vec3(_TileWidth, 0.f, _TileHeight);
-        // check if boundig box within camera radius
-        if(doCircleRectangleIntersect(cameraPosition, _RadiusHighLOD, 
-            tileUpLeft, tileUpRight, tileDownLeft, tileDownRight)){
-            tile->setLOD(GRASS_HIGH_LOD, cameraPosition);
-        } else {
-            tile->setLOD(GRASS_LOW_LOD, cameraPosition);
+void Grass::waitFrameFence(){
+    if(_FrameFence == nullptr) return;
+    GLenum status = glClientWaitSync(_FrameFence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+    if(status == GL_TIMEOUT_EXPIRED || status == GL_WAIT_FAILED){
+        fprintf(stderr, "Failed to wait for the previous frame!\n");
+        ErrorHandler::handle(ErrorCodes::GL_ERROR);
+    }
+    glDeleteSync(_FrameFence);
+    _FrameFence = nullptr;
+}
+
+void Grass::cullTiles(){
+    // culled draws must stay empty
+    glClearNamedBufferData(_IndirectBuffer, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+    GrassCullCounters counters = {(_MaxNbBlades + 63) / 64, 0, 1, 0, 0};
+    glNamedBufferSubData(_CullCountersBuffer, 0, sizeof(GrassCullCounters), &counters);
+
+    // the frustum and the camera are in the frame uniforms
+    auto& shader = _CullShader;
+    shader->use();
+    shader->setFloat("radiusRender", _RadiusRender);
+    shader->setInt("firstTileId", _Tiles.front()->_TileId);
+    shader->setInt("nbSlots", _NB_PARALLEL_BUFFERS);
+    shader->setInt("nbBladesPerSlot", _MAX_NB_GRASS_BLADES);
+    shader->setInt("maxNbBlades", _MaxNbBlades);
+    shader->setInt("minNbBlades", _MIN_NB_GRASS_BLADES);
+    setBladeCommandsUniforms(shader);
+
+    glDispatchCompute((_NB_PARALLEL_BUFFERS + 63) / 64, 1, 1);
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void Grass::compactBlades(){
+    auto& shader = _CompactShader;
+    shader->use();
+    shader->setFloat("radiusRender", _RadiusRender);
+    shader->setBool("bladesAsInstances", _Pipeline == GRASS_PIPELINE_VERTEX_PULLING);
+    shader->setFloat("segmentScale", _SegmentScale);
+
+    // one group per 64 blades of each visible draw
+    glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, _CullCountersBuffer);
+    glDispatchComputeIndirect(offsetof(GrassCullCounters, _NbGroupsX));
+    glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void Grass::setBladeCommandsUniforms(const ComputeShaderPointer& shader) const {
+    shader->setBool("bladesAsInstances", _Pipeline == GRASS_PIPELINE_VERTEX_PULLING);
+    shader->setInt("nbVertPerBlade", _MAX_NB_BLADE_VERT);
+}
+
+DrawArraysIndirectCommand Grass::getEmptyCommand() const {
+    // the blades compaction counts either the points or the strip instances
+    if(_Pipeline == GRASS_PIPELINE_GEOMETRY){
+        return {0, 1, 0, 0};
+    }
+    return {_MAX_NB_BLADE_VERT, 0, 0, 0};
+}
+
+bool Grass::readCounters(){
+    GLuint counters[2];
+    if(!_CountersReadback.read(counters)) return false;
+    _NbTriangles = counters[0];
+    _NbVisibleBlades = counters[1];
+    return true;
+}
+
+void Grass::updateBudget(const glm::mat4& proj){
+    // triangles of a frame a few frames late, the GPU isn't waited for
+    readCounters();
+    // one update per frame read by the profiler so a frame doesn't count several times toward the hold frames
+    GpuFrameTimes times;
+    if(_Profiler.popFrameTimes(times)){
+        _GpuTime = times._Times[GPU_PASS_GEOMETRY] + times._Times[GPU_PASS_GENERATION];
+        if(_Budget.update(_GpuTime, _NbTriangles)){
+            applyBudget();
         }
     }
+    // projected height in pixels of a 1 meter blade at 1 meter, per segment
+    float pixelsPerMeter = 0.5f * proj[1][1] * Application::_Height;
+    _SegmentScale = pixelsPerMeter / _PixelsPerSegment;
+}
+
+void Grass::applyBudget(){
+    // the far tiles and blades are dropped first, the cache keeps their blades
+    _RadiusRender = _MaxRadiusRender * _Budget.getRadiusScale();
+    _MaxNbBlades = std::max(_MIN_NB_GRASS_BLADES, GLuint(_MAX_NB_GRASS_BLADES * _Budget.getBladesScale()));
+    _PixelsPerSegment = _BASE_PIXELS_PER_SEGMENT * _Budget.getPixelsPerSegmentScale();
+    for(auto& tile : _Tiles){
+        tile->_RadiusRender = _RadiusRender;
+    }
+}
+
+void Grass::renderIndirect(Shaders* shaders){
+    shaders->use();
+    glBindVertexArray(_VAO);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _IndirectBuffer);
+    // the culled draws have no blades
+    glMultiDrawArraysIndirect(getDrawMode(), nullptr, _NB_PARALLEL_BUFFERS, 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
 }
 
 void Grass::initBuffersLighting(){
     glGenFramebuffers(1, &_Gbuffer);
     glBindFramebuffer(GL_FRAMEBUFFER, _Gbuffer);
-    auto error = glGetError();
 
     // color + specular color buffer
     glGenTextures(1, &_TextureColorSpec);
@@ -363,11 +613,7 @@ void Grass::initBuffersLighting(){
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _TextureColorSpec, 0);
-    error = glGetError();
-    if (error != GL_NO_ERROR) {
-        fprintf(stderr, "Failed to init color texture !\n\tOpenGL error: %s\n", gluErrorString(error));
-        ErrorHandler::handle(ErrorCodes::GL_ERROR);
-    }
+    ErrorHandler::checkGLError("Failed to init color texture!");
 
     // position color buffer
     glGenTextures(1, &_TexturePosition);
@@ -376,11 +622,7 @@ void Grass::initBuffersLighting(){
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, _TexturePosition, 0);
-    error = glGetError();
-    if (error != GL_NO_ERROR) {
-        fprintf(stderr, "Failed to init position texture !\n\tOpenGL error: %s\n", gluErrorString(error));
-        ErrorHandler::handle(ErrorCodes::GL_ERROR);
-    }
+    ErrorHandler::checkGLError("Failed to init position texture!");
 
     // normal color buffer
     glGenTextures(1, &_TextureNormal);
@@ -389,11 +631,7 @@ void Grass::initBuffersLighting(){
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, _TextureNormal, 0);
-    error = glGetError();
-    if (error != GL_NO_ERROR) {
-        fprintf(stderr, "Failed to init normal texture !\n\tOpenGL error: %s\n", gluErrorString(error));
-        ErrorHandler::handle(ErrorCodes::GL_ERROR);
-    }
+    ErrorHandler::checkGLError("Failed to init normal texture!");
 
 
     unsigned int attachments[3] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
@@ -410,11 +648,7 @@ void Grass::initBuffersLighting(){
         ErrorHandler::handle(ErrorCodes::GL_ERROR);
     }
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    error = glGetError();
-    if (error != GL_NO_ERROR) {
-        fprintf(stderr, "Failed to init texture buffers !\n\tOpenGL error: %s\n", gluErrorString(error));
-        ErrorHandler::handle(ErrorCodes::GL_ERROR);
-    }
+    ErrorHandler::checkGLError("Failed to init texture buffers!");
 
     // draw quad
     float vertices[] = {
@@ -460,13 +694,10 @@ void Grass::initBuffersLighting(){
 }
 
 void Grass::lightShaderPass(){
+    _Profiler.begin(GPU_PASS_LIGHTING);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     _LightShader->use();
-    auto error = glGetError();
-    if (error != GL_NO_ERROR) {
-        fprintf(stderr, "Failed to use light shader !\n\tOpenGL error: %s\n", gluErrorString(error));
-        ErrorHandler::handle(ErrorCodes::GL_ERROR);
-    }
+    ErrorHandler::checkGLError("Failed to use light shader!");
 
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, _TextureColorSpec);
@@ -474,23 +705,18 @@ void Grass::lightShaderPass(){
     glBindTexture(GL_TEXTURE_2D, _TexturePosition);
     glActiveTexture(GL_TEXTURE2);
     glBindTexture(GL_TEXTURE_2D, _TextureNormal);
-    error = glGetError();
-    if (error != GL_NO_ERROR) {
-        fprintf(stderr, "Failed to bind textures !\n\tOpenGL error: %s\n", gluErrorString(error));
-        ErrorHandler::handle(ErrorCodes::GL_ERROR);
-    }
+    ErrorHandler::checkGLError("Failed to bind textures!");
 
     // draw quad
     renderQuad();
-    error = glGetError();
-    if (error != GL_NO_ERROR) {
-        fprintf(stderr, "Failed to draw quad !\n\tOpenGL error: %s\n", gluErrorString(error));
-        ErrorHandler::handle(ErrorCodes::GL_ERROR);
-    }
+    ErrorHandler::checkGLError("Failed to draw quad!");
+    _Profiler.end(GPU_PASS_LIGHTING);
 
     // copy depth buffers
+    _Profiler.begin(GPU_PASS_DEPTH_BLIT);
     glBindFramebuffer(GL_READ_FRAMEBUFFER, _Gbuffer);
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _OutputFramebuffer);
     glBlitFramebuffer(0, 0, Application::_Width, Application::_Height, 0, 0, Application::_Width, Application::_Height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, _OutputFramebuffer);
+    _Profiler.end(GPU_PASS_DEPTH_BLIT);
 }
\ No newline at end of file
@@ -1,46 +1,118 @@
 #pragma once
 
+#include "bladeCache.hpp"
 #include "camera.hpp"
+#include "bladeGenerator.hpp"
+#include "bufferReadback.hpp"
 #include "computeShader.hpp"
 #include "frustum.hpp"
+#include "grassBlade.hpp"
+#include "grassBudget.hpp"
+#include "gpuProfiler.hpp"
 #include "material.hpp"
+#include "shaderRegistry.hpp"
 #include "shaders.hpp"
+#include "tileQuadtree.hpp"
 #include "utils.hpp"
+#include "windField.hpp"
 #include <glad/gl.h>
 #include <glm/fwd.hpp>
 #include <glm/glm.hpp>
+#include <array>
 #include <vector>
 
-enum GrassSizes{
-    GRASS_POSITION_NB_ELEMENT = 4,
-    GRASS_HEIGHT_NB_ELEMENT = 1,
-    GRASS_WIDTH_NB_ELEMENT = 1,
-    GRASS_COLOR_NB_ELEMENT = 4,
-    GRASS_ROTATION_NB_ELEMENT = 1,
-    GRASS_TILT_NB_ELEMENT = 1,
-    GRASS_BEND_NB_ELEMENT = 2,
-    GRASS_POSITION_BUFFER_ELEMENT_SIZE = 4*sizeof(float),
-    GRASS_HEIGHT_BUFFER_ELEMENT_SIZE = sizeof(float),
-    GRASS_WIDTH_BUFFER_ELEMENT_SIZE = sizeof(float),
-    GRASS_COLOR_BUFFER_ELEMENT_SIZE = 4*sizeof(float),
-    GRASS_ROTATION_BUFFER_ELEMENT_SIZE = sizeof(float),
-    GRASS_TILT_BUFFER_ELEMENT_SIZE = sizeof(float),
-    GRASS_BEND_BUFFER_ELEMENT_SIZE = 2*sizeof(float),
+enum GrassCulling{
+    GRASS_CULLING_CPU,
+    GRASS_CULLING_GPU,
 };
 
-enum GrassLOD{
-    GRASS_HIGH_LOD = 1,
-    GRASS_LOW_LOD = 2,
+/**
+ * @enum Where the blades of a tile are generated when it enters the cache
+*/
+enum GrassGeneration{
+    GRASS_GENERATION_GPU,   // grassCompute.glsl
+    GRASS_GENERATION_CPU,   // BladeGenerator, streamed into the persistently mapped grass buffers
+};
+
+/**
+ * @enum How the blades are expanded into triangles
+*/
+enum GrassPipeline{
+    GRASS_PIPELINE_GEOMETRY,        // one point per blade expanded by the geometry shader
+    GRASS_PIPELINE_VERTEX_PULLING,  // one triangle strip instance per blade
+};
+
+// the blades have between 1 and _MAX_NB_BLADE_SEGMENTS segments depending on their size on screen
+const GLuint _MAX_NB_BLADE_SEGMENTS = 7;
+// number of vertices of the most detailed blade's triangle strip
+const GLuint _MAX_NB_BLADE_VERT = 2 * _MAX_NB_BLADE_SEGMENTS + 1;
+// pixels per segment at full quality
+const float _BASE_PIXELS_PER_SEGMENT = 8.f;
+
+/**
+ * The layout expected by glMultiDrawArraysIndirect
+*/
+struct DrawArraysIndirectCommand{
+    GLuint _Count;
+    GLuint _InstanceCount;
+    GLuint _First;
+    GLuint _BaseInstance;
+};
+
+/**
+ * The tile information read by the vertex shader for each draw (std430)
+*/
+struct GrassDrawInfo{
+    GLuint _StartId;
+    GLuint _TileId;
+    GLuint _NbBlades;
+};
+
+/**
+ * The bounding box of a tile read by the culling shader (std430)
+*/
+struct GrassTileBounds{
+    glm::vec4 _Min;
+    glm::vec4 _Max;
+};
+
+/**
+ * The parameters of a tile read by the blades generation shader (std430)
+*/
+struct GrassTileParams{
+    glm::vec2 _TilePos;
+    GLint _TileWidth;
+    GLint _TileHeight;
+    GLint _GridNbCols;
+    GLint _GridNbLines;
+    GLint _TileId;
+    GLint _Padding;
+};
+
+/**
+ * The counters filled by the culling and compaction shaders (std430)
+ * The number of groups is the indirect dispatch of the blades compaction
+*/
+struct GrassCullCounters{
+    GLuint _NbGroupsX;
+    GLuint _NbGroupsY;      // number of visible draws
+    GLuint _NbGroupsZ;
+    GLuint _NbTriangles;    // triangles of the visible blades
+    GLuint _NbBlades;       // visible blades
 };
 
 class Grass;
 
-const GLuint _NB_PARALLEL_BUFFERS = 10;
-// const GLuint _NB_PARALLEL_BUFFERS = 100;
+// each parallel buffer is a slot of the blade cache
+// must hold every tile within the render radius when culling on the gpu
+// const GLuint _NB_PARALLEL_BUFFERS = 10;
+const GLuint _NB_PARALLEL_BUFFERS = 256;
 const GLuint _MAX_NB_GRASS_BLADES = 8192;
 // const GLuint _MAX_NB_GRASS_BLADES = 4096;
 // const GLuint _MIN_NB_GRASS_BLADES = 1024;
 const GLuint _MIN_NB_GRASS_BLADES = 256;
+// size of the clump table of each parallel buffer, one clump per cell of the tile's grid
+const GLuint _MAX_NB_CLUMPS = 256;
 
 
 class GrassTile{
@@ -52,9 +124,7 @@ class GrassTile{
         static GLint _MaxWorkGroupCountX, _MaxWorkGroupCountY, _MaxWorkGroupCountZ;
 
     private:
-        // GLuint _NbGrassBlades = 10;
-        GLuint _NbGrassBlades = _MAX_NB_GRASS_BLADES;
-        // GLuint _NbGrassBlades = 2 << 20;
+        // one clump per cell, at most _MAX_NB_CLUMPS cells
         GLuint _GridNbCols = 16;
         GLuint _GridNbLines = 16;
         // GLfloat _TileLength = 0.5f;
@@ -62,77 +132,27 @@ class GrassTile{
         glm::vec2 _TilePos;
         GLuint _TileHeight;
         GLuint _TileWidth;
-        GrassLOD _LOD; 
-        GLuint _RadiusRender = 30.f;
-        ComputeShader* _ComputeShader = nullptr;
+        float _RadiusRender = 30.f;
+        // shared by every tile
+        ComputeShaderPointer _ComputeShader = nullptr;
 
 
     private:
-        bool isTileCornerInFrontOfPlane(const Plane& plane, const glm::vec3& tileCorner){
-            float result = plane.getSignedDistanceToPlane(tileCorner);
-            return result >= 0;
-        }
-
-        bool isTileCornerInFrustum(const Frustum& frustum, const glm::vec3& tileCorner){
-            bool isWithinFrustum = true;
-            return 
-                   isTileCornerInFrontOfPlane(frustum._BottomFace, tileCorner)
-                && isTileCornerInFrontOfPlane(frustum._TopFace, tileCorner)
-                && isTileCornerInFrontOfPlane(frustum._LeftFace, tileCorner)
-                && isTileCornerInFrontOfPlane(frustum._RightFace, tileCorner)
-                && isTileCornerInFrontOfPlane(frustum._FarFace, tileCorner)
-                && isTileCornerInFrontOfPlane(frustum._NearFace, tileCorner);
-        }
-
-        bool isTileInFrustrum(const Frustum& frustum, const std::vector<glm::vec3>& corners){
-            for(const auto& corner : corners){
-                glm::vec3 cornerTmp = glm::vec3(corner.x, corner.y, corner.z);
-                if(isTileCornerInFrustum(frustum, cornerTmp)){
-                    return true;
-                }
-            }
-            return false;
-        }
         void initShader(const std::string& shaderPath);
 
     public:
         GrassTile(const glm::vec2& tilePos, GLuint tileWidth, GLuint tileHeight,
-                GrassLOD tileLOD = GRASS_LOW_LOD, const std::string& shaderPath = "shader/grassCompute.glsl");
+                const std::string& shaderPath = "shader/grassCompute.glsl");
         
-        void dispatchComputeShader(int parallelId, GLuint vao);
-        void render(Shaders* shaders, float time, GLuint vao);
+        /**
+         * Generate the blades of the tile
+         * @param tileIndex The index of the tile in the grid, its parameters in the tile params buffer
+         * @param parallelId The slot of the blade cache filled
+         * @param vao The grass vao
+        */
+        void dispatchComputeShader(GLuint tileIndex, int parallelId, GLuint vao);
         // void render(Shaders* shaders, float time, int parallelTileNb, GLuint vao);
 
-        void setNbBlades(const glm::vec3& cameraPosition){
-            glm::vec3 projectedCameraPosition = glm::vec3(cameraPosition.x, 0.f, cameraPosition.z);
-            glm::vec3 projectedTilePosition = getCenter();
-            float dist = glm::distance(projectedCameraPosition, projectedTilePosition);
-
-            if(dist > _RadiusRender){
-                _NbGrassBlades = _MIN_NB_GRASS_BLADES;
-                return;
-            }
-            float alpha = (dist/_RadiusRender);
-            _NbGrassBlades = _MAX_NB_GRASS_BLADES * (1.f - alpha) + _MIN_NB_GRASS_BLADES * alpha;
-            // std::cout << "alpha: " << alpha << ", nb b: " << _NbGrassBlades << ", pos: ";
-            // printGlm(projectedTilePosition);
-            // std::cout << ", cam pos: ";
-            // printGlm(projectedCameraPosition);
-            // std::cout << std::endl;
-        }
-
-        void setLOD(GrassLOD newLOD, const glm::vec3& cameraPosition){
-            _LOD = newLOD;
-            switch (_LOD) {
-                case GRASS_HIGH_LOD:
-                    setNbBlades(cameraPosition);
-                    break;
-                case GRASS_LOW_LOD:
-                    setNbBlades(cameraPosition);
-                    break;
-            }
-        }
-
         glm::vec3 getCenter() const {
             return getPos() + glm::vec3(_TileWidth >> 1, 0.f, _TileHeight >> 1);
         }
@@ -146,32 +166,28 @@ class GrassTile{
         }
 
 
-        // bool shouldBeRendered(const glm::vec3& cameraPosition, const glm::mat4& mvp){
-        bool shouldBeRendered(const glm::vec3& cameraPosition, const Frustum& frustum){
-            // auto startTest = std::chrono::high_resolution_clock::now();
-            
-            std::vector<glm::vec3> corners = {
-                getPos(), // upleft
-                getPos() + glm::vec3(_TileWidth, 0.f, 0.f), // upright
-                getPos() + glm::vec3(0.f, 0.f, _TileHeight), //downleft
-                getPos() + glm::vec3(_TileWidth, 0.f, _TileHeight) //downright
-            };
+        /**
+         * Get the bounding box of the tile's blades, with their tilt, bend and animation
+        */
+        glm::vec3 getBoundsMin() const {
+            return getPos() - glm::vec3(_MAX_BLADE_REACH, 0.f, _MAX_BLADE_REACH);
+        }
 
-            bool withinCircle = doCircleRectangleIntersect(
+        glm::vec3 getBoundsMax() const {
+            return getPos() + glm::vec3(_TileWidth + _MAX_BLADE_REACH, _MAX_BLADE_TOP, _TileHeight + _MAX_BLADE_REACH);
+        }
+
+        bool isWithinRenderRadius(const glm::vec3& cameraPosition) const {
+            glm::vec3 minCorner = getBoundsMin();
+            glm::vec3 maxCorner = getBoundsMax();
+            return doCircleRectangleIntersect(
                 glm::vec3(cameraPosition.x, 0.f, cameraPosition.z), 
                 _RadiusRender,
-                corners[0], corners[1], corners[2], corners[3]
+                glm::vec3(minCorner.x, 0.f, minCorner.z), // upleft
+                glm::vec3(maxCorner.x, 0.f, minCorner.z), // upright
+                glm::vec3(minCorner.x, 0.f, maxCorner.z), //downleft
+                glm::vec3(maxCorner.x, 0.f, maxCorner.z) //downright
             );
-            if(!withinCircle) return false;
-
-            // if all 4 corners are behind the camera projected on z = 0, don't render
-            bool inFrustrum = isTileInFrustrum(frustum, corners);
-
-            // auto endTest = std::chrono::high_resolution_clock::now();
-            // displayTime(startTest, endTest, "test");
-
-            return inFrustrum;
-            // return true;
         }
 };
 
@@ -184,24 +200,73 @@ class Grass{
         GLuint _TileWidth = 4;
         // GLuint _TileHeight = 16;
         GLuint _TileHeight = 4;
-        float _RadiusHighLOD = 20.f;
+        float _MaxRadiusRender = 30.f;
+        float _RadiusRender = _MaxRadiusRender;
+        // the blades get one segment per _PixelsPerSegment pixels of height on screen
+        float _PixelsPerSegment = _BASE_PIXELS_PER_SEGMENT;
+        GLuint _MaxNbBlades = _MAX_NB_GRASS_BLADES;
+        GLuint _NbTriangles = 0;
+        GLuint _NbVisibleBlades = 0;
+        float _SegmentScale = 0.f;
+
+        // density scaled to the gpu time of the grass pass
+        GrassBudget _Budget;
+        // gpu time in ms of the generation and the geometry pass of the last frame read by the profiler
+        float _GpuTime = 0.f;
+        // per pass gpu times, shown by the analytics
+        GpuProfiler _Profiler;
+        // wind sampled by the blades, rendered once per frame
+        WindField _Wind;
+        // framebuffer receiving the lit image, the window's or an offscreen one
+        GLuint _OutputFramebuffer = 0;
+        GrassCulling _Culling = GRASS_CULLING_GPU;
+        GrassPipeline _Pipeline = GRASS_PIPELINE_GEOMETRY;
+        GrassGeneration _Generation = GRASS_GENERATION_GPU;
 
         MaterialPointer _Material = nullptr;
+        // the tiles are allocated once, contiguously, in the grid order
+        std::vector<GrassTile> _TilePool;
         std::vector<GrassTile*> _Tiles;
-        float _TotalTime = 0.f;
-
-        // buffers compute shader
-        GLuint _PositionBuffer;
-        GLuint _HeightBuffer;
-        GLuint _WidthBuffer;
-        GLuint _ColorBuffer;
-        GLuint _RotationBuffer;
-        GLuint _TiltBuffer;
-        GLuint _BendBuffer;
-
-        // buffers vertex shader
+
+        // hierarchy of the cpu culling over the tiles grid
+        TileQuadtree _TileQuadtree;
+
+        // tiles blades kept in the grass buffers between frames
+        BladeCache _BladeCache = BladeCache(_NB_PARALLEL_BUFFERS);
+
+        // buffers compute shader, one packed record per blade
+        GLuint _BladeBuffer;
+        GLuint _ClumpBuffer;
+        // parameters of the tiles, indexed by tile
+        GLuint _TileParamsBuffer;
+        // mapped grass buffers of the cpu generation, the slots are only written
+        // once the gpu is done with the previous frame
+        GrassBlade* _MappedBlades = nullptr;
+        GrassClump* _MappedClumps = nullptr;
+        GLsync _FrameFence = nullptr;
+
+        // buffers vertex shader, the blades are pulled from the blade buffer
         GLuint _VAO;
 
+        // buffers indirect draws, one command per slot of the blade cache on the gpu culling and per visible slot
+        // on the cpu culling, the compaction sets the counts so the culled slots and blades draw nothing
+        GLuint _IndirectBuffer;
+        GLuint _DrawInfoBuffer;
+        std::array<DrawArraysIndirectCommand, _NB_PARALLEL_BUFFERS> _DrawCommands;
+        std::array<GrassDrawInfo, _NB_PARALLEL_BUFFERS> _DrawInfos;
+
+        // buffers gpu culling, the visible draws are packed at the front of the indirect buffer
+        ComputeShaderPointer _CullShader = nullptr;
+        GLuint _TileBoundsBuffer;
+        GLuint _SlotTilesBuffer;
+        GLuint _CullCountersBuffer;
+        // triangles and visible blades of the counters, read a few frames late
+        BufferReadback _CountersReadback{2 * sizeof(GLuint)};
+
+        // buffers blades compaction, only the blades within the frustum are drawn
+        ComputeShaderPointer _CompactShader = nullptr;
+        GLuint _VisibleBladesBuffer;
+
         // buffers for lighting
         GLuint _Gbuffer;
         GLuint _TexturePosition;
@@ -215,7 +280,29 @@ class Grass{
         void initBuffersLighting();
 
         void initBuffers();
-        void updateRenderingBuffers();
+        void initCullingBuffers();
+        void initTileParamsBuffer();
+
+        void renderCulledOnCPU(Shaders* shaders, const glm::vec3& cameraPosition, const Frustum& frustum);
+        void renderCulledOnGPU(Shaders* shaders, const glm::vec3& cameraPosition);
+        void updateResidency(const glm::vec3& cameraPosition);
+        void generateBlades(GrassTile* tile, GLuint slot);
+        void waitFrameFence();
+        void cullTiles();
+        void compactBlades();
+        void renderIndirect(Shaders* shaders);
+        void setBladeCommandsUniforms(const ComputeShaderPointer& shader) const;
+        DrawArraysIndirectCommand getEmptyCommand() const;
+        void updateBudget(const glm::mat4& proj);
+        void applyBudget();
+
+        GLenum getDrawMode() const {
+            return _Pipeline == GRASS_PIPELINE_GEOMETRY ? GL_POINTS : GL_TRIANGLE_STRIP;
+        }
+
+        GrassTile* getTile(GLuint tileId) const {
+            return _Tiles[tileId - _Tiles.front()->_TileId];
+        }
 
         // void checkBufferReadError(const std::string& bufferName) const {
         //     auto error = glGetError();
@@ -268,24 +355,110 @@ class Grass{
         // }
 
         // void printBuffers() const {
-        //     printVec4Buffer(_PositionBuffer, "Position");
-        //     printFloatBuffer(_HeightBuffer, "Height");
-        //     printFloatBuffer(_HeightBuffer, "Width");
-        //     printVec4Buffer(_ColorBuffer, "Color");
-        //     printFloatBuffer(_RotationBuffer, "Rotation");
-        //     printFloatBuffer(_TiltBuffer, "Tilt");
-        //     printVec2Buffer(_BendBuffer, "Bend");
+        //     std::vector<GrassBlade> blades(_MAX_NB_GRASS_BLADES);
+        //     glGetNamedBufferSubData(_BladeBuffer, 0, blades.size() * sizeof(GrassBlade), blades.data());
+        //     checkBufferReadError("Blade");
+        //     for(const auto& blade : blades){
+        //         std::cout << blade.getHeight() << "," << blade.getWidth() << "," << blade.getTilt() << " ";
+        //     }
+        //     std::cout << std::endl;
         //     exit(EXIT_SUCCESS);
         // }
 
     public:
-        Grass();
-        void renderBatch(Shaders* shaders, float time, 
-            const std::array<GrassLOD, _NB_PARALLEL_BUFFERS>& lods, 
-            const std::array<int, _NB_PARALLEL_BUFFERS>&  nbBlades
-        );
+        /**
+         * Basic constructor
+         * @param generation Where the blades are generated, the grass buffers are mapped for the cpu
+        */
+        Grass(GrassGeneration generation = GRASS_GENERATION_GPU);
+        void renderBatch(Shaders* shaders, const std::array<int, _NB_PARALLEL_BUFFERS>&  nbBlades);
         void render(Shaders* shaders, const Camera* camera, const glm::mat4& view, const glm::mat4& proj);
-        void update(float dt, const glm::vec3& cameraPosition);
+        const BladeCache& getBladeCache() const {
+            return _BladeCache;
+        }
+
+        GLuint getNbTriangles() const {
+            return _NbTriangles;
+        }
+
+        GLuint getNbVisibleBlades() const {
+            return _NbVisibleBlades;
+        }
+
+        /**
+         * Get the number of blades generated by the frame, for the tiles entering the cache
+        */
+        GLuint getNbGeneratedBlades() const {
+            return _BladeCache.getFrameMisses() * _MAX_NB_GRASS_BLADES;
+        }
+
+        /**
+         * Read back the triangles and the blades drawn by the newest frame the GPU is done with, without waiting
+         * @return False if no new frame is done, the counters are left as is
+        */
+        bool readCounters();
+
+        /**
+         * Generate the first tile with the compute shader and with BladeGenerator, read it back and compare them
+         * The positions and the clumps must be equal, the half floats within 2 ulps,
+         * the packed rotation within 1 step and the clump colors within 1e-5
+         * @return False if a blade or a clump differs, the first differences are printed
+        */
+        bool verifyGeneration();
+
+        float getPixelsPerSegment() const {
+            return _PixelsPerSegment;
+        }
+
+        float getGpuTime() const {
+            return _GpuTime;
+        }
+
+        const GrassBudget& getBudget() const {
+            return _Budget;
+        }
+
+        const GpuProfiler& getProfiler() const {
+            return _Profiler;
+        }
+
+        GpuProfiler& getProfiler(){
+            return _Profiler;
+        }
+
+        /**
+         * Set the budget of the grass pass
+         * @param targetTime The target GPU time in ms, 0 to only use the triangle budget
+         * @param triangleBudget The maximum number of triangles per frame
+        */
+        void setBudget(float targetTime, GLuint triangleBudget){
+            _Budget = GrassBudget(targetTime, triangleBudget);
+            applyBudget();
+        }
+
+        void setCulling(GrassCulling culling){
+            _Culling = culling;
+        }
+
+        void setPipeline(GrassPipeline pipeline){
+            _Pipeline = pipeline;
+        }
+
+        /**
+         * Set how the blades get the wind, the blades' shaders must be compiled with WindField::getDefines
+         * @param mode The wind mode
+        */
+        void setWindMode(WindMode mode){
+            _Wind.setMode(mode);
+        }
+
+        /**
+         * Set the framebuffer the lighting pass draws into
+         * @param framebuffer The framebuffer, 0 for the window
+        */
+        void setOutputFramebuffer(GLuint framebuffer){
+            _OutputFramebuffer = framebuffer;
+        }
 
         glm::vec3 getCenter() const {
             float x = 0.5f * (_NbTileLength * _TileWidth);
@@ -297,11 +470,7 @@ class Grass{
     private:
         void initLightShader(){
             initBuffersLighting();
-            auto error = glGetError();
-            if (error != GL_NO_ERROR) {
-                fprintf(stderr, "Failed to init light buffers !\n\tOpenGL error: %s\n", gluErrorString(error));
-                ErrorHandler::handle(ErrorCodes::GL_ERROR);
-            }
+            ErrorHandler::checkGLError("Failed to init light buffers!");
             _LightShader = ShadersPointer(
                 new Shaders("shader/grassLightVert.glsl", "shader/grassLightFrag.glsl")
             );
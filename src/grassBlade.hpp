@@ -0,0 +1,71 @@
+#pragma once
+
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+
+// bounds of a blade around its base, the animation of the shaders included (see grassCompact.glsl)
+const float _MAX_BLADE_HEIGHT = 0.5f;
+const float _MAX_BLADE_WIDTH = 0.05f;
+const float _MAX_BLADE_WIND_DISPLACEMENT = 1.f;
+const float _MAX_BLADE_ANIMATION_DISPLACEMENT_X = 0.1f;
+const float _MAX_BLADE_ANIMATION_DISPLACEMENT_Y = 0.05f;
+// the tilt and the bend are at most the height
+const float _MAX_BLADE_REACH = _MAX_BLADE_HEIGHT + _MAX_BLADE_WIND_DISPLACEMENT
+    + _MAX_BLADE_ANIMATION_DISPLACEMENT_X + 0.5f * _MAX_BLADE_WIDTH;
+const float _MAX_BLADE_TOP = _MAX_BLADE_HEIGHT + _MAX_BLADE_ANIMATION_DISPLACEMENT_Y;
+
+/**
+ * The packed record of a grass blade, must match the Blade struct of the shaders (std430)
+ * The blades stand on the ground so only the x and z coordinates are stored
+*/
+struct GrassBlade{
+    float _PosX;
+    float _PosZ;
+    GLuint _HeightWidth;        // half2(height, width)
+    GLuint _TiltBendX;          // half2(tilt, bend.x)
+    GLuint _BendYRotation;      // half(bend.y) | 16 bits angle << 16
+    GLuint _Clump;              // index in the clump table
+
+    /**
+     * Pack the attributes of a blade
+     * @param position The blade's base position
+     * @param height The blade's height
+     * @param width The blade's width
+     * @param clump The index of the blade's clump in the clump table
+     * @param rotation The blade's rotation in radians, in [0, 2pi[
+     * @param tilt The blade's tilt
+     * @param bend The blade's bend
+     * @return The packed blade
+    */
+    static GrassBlade pack(const glm::vec4& position, float height, float width, GLuint clump,
+        float rotation, float tilt, const glm::vec2& bend){
+        GLuint angle = GLuint(rotation * (65536.f / glm::two_pi<float>())) & 0xffff;
+        GLuint bendY = glm::packHalf2x16(glm::vec2(bend.y, 0.f)) & 0xffff;
+        return {
+            position.x,
+            position.z,
+            glm::packHalf2x16(glm::vec2(height, width)),
+            glm::packHalf2x16(glm::vec2(tilt, bend.x)),
+            bendY | (angle << 16),
+            clump
+        };
+    }
+
+    glm::vec4 getPosition() const {return glm::vec4(_PosX, 0.f, _PosZ, 1.f);}
+    float getHeight() const {return glm::unpackHalf2x16(_HeightWidth).x;}
+    float getWidth() const {return glm::unpackHalf2x16(_HeightWidth).y;}
+    float getTilt() const {return glm::unpackHalf2x16(_TiltBendX).x;}
+    glm::vec2 getBend() const {
+        return glm::vec2(glm::unpackHalf2x16(_TiltBendX).y, glm::unpackHalf2x16(_BendYRotation).x);
+    }
+    float getRotation() const {return float(_BendYRotation >> 16) * (glm::two_pi<float>() / 65536.f);}
+};
+
+static_assert(sizeof(GrassBlade) == 24, "The grass blade record must match the shaders' layout");
+
+/**
+ * The parameters shared by the blades of a clump, must match the Clump struct of the shaders (std430)
+*/
+struct GrassClump{
+    glm::vec4 _Color;
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <algorithm>
+#include <glad/gl.h>
+
+/**
+ * Scale the grass density to keep the grass pass within a GPU time and a triangle budget
+ * The quality only changes after several frames over or under the budget so it doesn't oscillate
+*/
+class GrassBudget{
+
+    private:
+        // target GPU time of the grass pass in ms, 0 to only use the triangle budget
+        float _TargetTime = 8.f;
+        GLuint _TriangleBudget = 4000000;
+
+        // the budget is met between (1 - _Hysteresis) and (1 + _Hysteresis) times the target
+        float _Hysteresis = 0.1f;
+        GLuint _NbHoldFrames = 10;
+        GLuint _NbFramesOver = 0;
+        GLuint _NbFramesUnder = 0;
+
+        // drop the quality faster than it comes back
+        float _StepDown = 0.1f;
+        float _StepUp = 0.05f;
+        float _MinQuality = 0.25f;
+        float _Quality = 1.f;
+
+    public:
+        GrassBudget(){}
+
+        /**
+         * Basic constructor
+         * @param targetTime The target GPU time of the grass pass in ms, 0 to disable it
+         * @param triangleBudget The maximum number of triangles per frame
+        */
+        GrassBudget(float targetTime, GLuint triangleBudget)
+            : _TargetTime(targetTime), _TriangleBudget(triangleBudget){}
+
+        /**
+         * Update the quality with the last measures
+         * @param gpuTime The last GPU time of the grass pass in ms
+         * @param nbTriangles The number of triangles of the last frame
+         * @return True if the quality changed
+        */
+        bool update(float gpuTime, GLuint nbTriangles){
+            bool hasTargetTime = _TargetTime > 0.f;
+            bool isOver = (hasTargetTime && gpuTime > _TargetTime * (1.f + _Hysteresis))
+                || nbTriangles > _TriangleBudget;
+            bool isUnder = (!hasTargetTime || gpuTime < _TargetTime * (1.f - _Hysteresis))
+                && nbTriangles < _TriangleBudget * (1.f - _Hysteresis);
+
+            _NbFramesOver = isOver ? _NbFramesOver + 1 : 0;
+            _NbFramesUnder = isUnder ? _NbFramesUnder + 1 : 0;
+
+            float quality = _Quality;
+            if(_NbFramesOver >= _NbHoldFrames){
+                quality = std::max(_Quality - _StepDown, _MinQuality);
+                _NbFramesOver = 0;
+            }
+            if(_NbFramesUnder >= _NbHoldFrames){
+                quality = std::min(_Quality + _StepUp, 1.f);
+                _NbFramesUnder = 0;
+            }
+
+            bool hasChanged = quality != _Quality;
+            _Quality = quality;
+            return hasChanged;
+        }
+
+        /**
+         * Get the quality
+         * @return The quality in [_MinQuality, 1]
+        */
+        float getQuality() const {return _Quality;}
+
+        /**
+         * Get the scale of the number of blades per tile
+        */
+        float getBladesScale() const {return _Quality;}
+
+        /**
+         * Get the scale of the render radius, the far tiles are dropped last
+        */
+        float getRadiusScale() const {return 0.5f + 0.5f * _Quality;}
+
+        /**
+         * Get the scale of the pixels per blade segment, the blades get coarser at lower quality
+        */
+        float getPixelsPerSegmentScale() const {return 1.f / _Quality;}
+
+        float getTargetTime() const {return _TargetTime;}
+        GLuint getTriangleBudget() const {return _TriangleBudget;}
+};
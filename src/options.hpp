@@ -0,0 +1,194 @@
+#pragma once
+
+#include "errorHandler.hpp"
+#include "glDebug.hpp"
+#include "grass.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+/**
+ * The options of the application, selected on the command line
+*/
+struct ApplicationOptions{
+    GrassPipeline _Pipeline = GRASS_PIPELINE_GEOMETRY;
+    GrassCulling _Culling = GRASS_CULLING_GPU;
+    GrassGeneration _Generation = GRASS_GENERATION_GPU;
+    WindMode _Wind = WIND_MODE_TEXTURE;
+    // target GPU time of the grass pass in ms, 0 to only use the triangle budget
+    float _TargetGpuTime = 8.f;
+    GLuint _TriangleBudget = 4000000;
+    // directory of the program binaries, empty to always compile the shaders
+    std::string _ShaderCacheDirectory = "cache";
+    // lowest severity reported by the GL debug output, GL_NONE to poll the error flag
+    GLenum _GLDebugSeverity = GL_NONE;
+    // report the debug messages during the GL call raising them
+    bool _GLDebugSynchronous = false;
+    // resolution of the window, or of the offscreen framebuffer when headless
+    GLuint _Width = 1280;
+    GLuint _Height = 720;
+    // render a fixed number of frames offscreen, along a camera path, then print a timing report
+    bool _Headless = false;
+    GLuint _NbFrames = 600;
+    // keyframes of the camera path, an orbit around the field when empty
+    std::string _CameraPath = "";
+    // time step of the simulation in s, 0 to follow the clock, the headless mode defaults to 60 steps per s
+    float _FixedTimestep = 0.f;
+    // duration of a step of the simulation clock in s
+    float _SimulationStep = 1.f / 60.f;
+    // json file of the per frame results of the headless mode, empty to only print the summary
+    std::string _BenchOutput = "";
+    // generate a tile with the compute shader and with BladeGenerator and compare them instead of rendering
+    bool _VerifyGeneration = false;
+
+    /**
+     * Print the accepted options
+     * @param program The name of the executable
+    */
+    static void printUsage(const char* program){
+        fprintf(stderr, "Usage: %s [--pipeline geometry|pulling] [--culling gpu|cpu] [--generation gpu|cpu]"
+            " [--gpu-budget <ms>] [--triangle-budget <count>] [--shader-cache <directory>|off]"
+            " [--gl-debug high|medium|low|notification] [--gl-debug-sync] [--resolution <width>x<height>]"
+            " [--headless] [--frames <count>] [--camera-path <file>] [--fixed-timestep <s>]"
+            " [--simulation-step <s>] [--bench-output <file>] [--wind texture|analytic|compare]"
+            " [--verify-generation]\n", program);
+    }
+
+    /**
+     * Check if an argument is a positive or null number
+     * @param value The argument
+    */
+    static bool isValidFloat(const char* value){
+        char* end = nullptr;
+        float number = strtof(value, &end);
+        return end != value && *end == '\0' && number >= 0.f;
+    }
+
+    /**
+     * Check if an argument is a strictly positive 32 bits integer
+     * @param value The argument
+    */
+    static bool isValidCount(const char* value){
+        char* end = nullptr;
+        unsigned long number = strtoul(value, &end, 10);
+        return end != value && *end == '\0' && value[0] != '-' && number > 0 && number <= 0xffffffffUL;
+    }
+
+    /**
+     * Parse a resolution
+     * @param value The argument, <width>x<height>
+     * @param width The width
+     * @param height The height
+     * @return False if the argument isn't a resolution
+    */
+    static bool parseResolution(const char* value, GLuint& width, GLuint& height){
+        unsigned int w = 0;
+        unsigned int h = 0;
+        char end = '\0';
+        if(sscanf(value, "%ux%u%c", &w, &h, &end) != 2 || w == 0 || h == 0) return false;
+        width = w;
+        height = h;
+        return true;
+    }
+
+    /**
+     * Parse the command line arguments
+     * @param argc The number of arguments
+     * @param argv The arguments
+     * @return The options, the defaults for the missing arguments
+    */
+    static ApplicationOptions parse(int argc, char** argv){
+        ApplicationOptions options;
+        GLenum severity = GL_NONE;
+        WindMode wind = WIND_MODE_TEXTURE;
+        GLuint width = 0;
+        GLuint height = 0;
+        for(int i=1; i<argc; i++){
+            // options without value
+            if(strcmp(argv[i], "--headless") == 0){
+                options._Headless = true;
+                continue;
+            }
+            if(strcmp(argv[i], "--gl-debug-sync") == 0){
+                options._GLDebugSynchronous = true;
+                continue;
+            }
+            if(strcmp(argv[i], "--verify-generation") == 0){
+                options._VerifyGeneration = true;
+                options._Headless = true;
+                continue;
+            }
+
+            const char* value = i+1 < argc ? argv[i+1] : "";
+
+            if(strcmp(argv[i], "--pipeline") == 0 && strcmp(value, "geometry") == 0){
+                options._Pipeline = GRASS_PIPELINE_GEOMETRY;
+            }
+            else if(strcmp(argv[i], "--pipeline") == 0 && strcmp(value, "pulling") == 0){
+                options._Pipeline = GRASS_PIPELINE_VERTEX_PULLING;
+            }
+            else if(strcmp(argv[i], "--culling") == 0 && strcmp(value, "gpu") == 0){
+                options._Culling = GRASS_CULLING_GPU;
+            }
+            else if(strcmp(argv[i], "--culling") == 0 && strcmp(value, "cpu") == 0){
+                options._Culling = GRASS_CULLING_CPU;
+            }
+            else if(strcmp(argv[i], "--generation") == 0 && strcmp(value, "gpu") == 0){
+                options._Generation = GRASS_GENERATION_GPU;
+            }
+            else if(strcmp(argv[i], "--generation") == 0 && strcmp(value, "cpu") == 0){
+                options._Generation = GRASS_GENERATION_CPU;
+            }
+            else if(strcmp(argv[i], "--gpu-budget") == 0 && isValidFloat(value)){
+                options._TargetGpuTime = strtof(value, nullptr);
+            }
+            else if(strcmp(argv[i], "--triangle-budget") == 0 && isValidCount(value)){
+                options._TriangleBudget = GLuint(strtoul(value, nullptr, 10));
+            }
+            else if(strcmp(argv[i], "--shader-cache") == 0 && strcmp(value, "off") == 0){
+                options._ShaderCacheDirectory = "";
+            }
+            else if(strcmp(argv[i], "--shader-cache") == 0 && value[0] != '\0'){
+                options._ShaderCacheDirectory = value;
+            }
+            else if(strcmp(argv[i], "--gl-debug") == 0 && GLDebug::parseSeverity(value, severity)){
+                options._GLDebugSeverity = severity;
+            }
+            else if(strcmp(argv[i], "--resolution") == 0 && parseResolution(value, width, height)){
+                options._Width = width;
+                options._Height = height;
+            }
+            else if(strcmp(argv[i], "--frames") == 0 && isValidCount(value)){
+                options._NbFrames = GLuint(strtoul(value, nullptr, 10));
+            }
+            else if(strcmp(argv[i], "--camera-path") == 0 && value[0] != '\0'){
+                options._CameraPath = value;
+            }
+            else if(strcmp(argv[i], "--fixed-timestep") == 0 && isValidFloat(value)){
+                options._FixedTimestep = strtof(value, nullptr);
+            }
+            else if(strcmp(argv[i], "--simulation-step") == 0 && isValidFloat(value) && strtof(value, nullptr) > 0.f){
+                options._SimulationStep = strtof(value, nullptr);
+            }
+            else if(strcmp(argv[i], "--wind") == 0 && WindField::parseMode(value, wind)){
+                options._Wind = wind;
+            }
+            else if(strcmp(argv[i], "--bench-output") == 0 && value[0] != '\0'){
+                options._BenchOutput = value;
+            }
+            else{
+                fprintf(stderr, "Unknown option: %s %s\n", argv[i], value);
+                printUsage(argv[0]);
+                ErrorHandler::handle(ErrorCodes::BAD_VALUE);
+            }
+            i++;
+        }
+        // the synchronous output reports the errors by default
+        if(options._GLDebugSynchronous && options._GLDebugSeverity == GL_NONE){
+            options._GLDebugSeverity = GL_DEBUG_SEVERITY_HIGH;
+        }
+        return options;
+    }
+};
@@ -0,0 +1,186 @@
+#include "programCache.hpp"
+#include "errorHandler.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+
+std::string ProgramCache::getDriver(){
+    const char* renderer = (const char*)glGetString(GL_RENDERER);
+    const char* version = (const char*)glGetString(GL_VERSION);
+    return std::string(renderer ? renderer : "") + "\n" + std::string(version ? version : "");
+}
+
+std::string ProgramCache::addIncludes(const std::string& code, const std::string& path){
+    std::vector<std::string> includedPaths = {path};
+    return expandIncludes(code, path, 0, includedPaths);
+}
+
+std::string ProgramCache::expandIncludes(const std::string& code, const std::string& path, GLuint sourceId,
+    std::vector<std::string>& includedPaths){
+    const std::string directive = "#include \"";
+    size_t slash = path.find_last_of('/');
+    std::string directory = slash == std::string::npos ? "" : path.substr(0, slash + 1);
+
+    std::string expanded;
+    size_t start = 0;
+    GLuint lineNumber = 0;
+    while(start < code.size()){
+        size_t end = code.find('\n', start);
+        if(end == std::string::npos) end = code.size();
+        std::string line = code.substr(start, end - start);
+        start = end + 1;
+        lineNumber++;
+
+        size_t nameEnd = line.find('"', directive.size());
+        if(line.compare(0, directive.size(), directive) != 0 || nameEnd == std::string::npos){
+            expanded += line + "\n";
+            continue;
+        }
+        std::string includePath = directory + line.substr(directive.size(), nameEnd - directive.size());
+        // each file is expanded once, which also ends the include cycles, the line is kept empty for the numbering
+        if(std::find(includedPaths.begin(), includedPaths.end(), includePath) != includedPaths.end()){
+            expanded += "\n";
+            continue;
+        }
+        std::ifstream file(includePath);
+        if(!file){
+            fprintf(stderr, "Failed to read the file: %s!\n", includePath.c_str());
+            ErrorHandler::handle(ErrorCodes::IO_ERROR);
+        }
+        std::stringstream stream;
+        stream << file.rdbuf();
+        includedPaths.push_back(includePath);
+
+        // the compiler's errors are reported as <source>:<line>, the source being the order of inclusion
+        GLuint includeId = includedPaths.size() - 1;
+        expanded += "#line 1 " + std::to_string(includeId) + "\n";
+        expanded += expandIncludes(stream.str(), includePath, includeId, includedPaths);
+        expanded += "#line " + std::to_string(lineNumber + 1) + " " + std::to_string(sourceId) + "\n";
+    }
+    return expanded;
+}
+
+std::string ProgramCache::addDefines(const std::string& code, const std::string& defines){
+    if(defines.empty()) return code;
+    // the #version must stay the first line
+    size_t endOfVersion = code.find('\n', code.find("#version"));
+    if(endOfVersion == std::string::npos){
+        return code + "\n" + defines + "\n";
+    }
+    // the lines after the defines keep their numbers in the compiler's errors
+    GLuint nextLine = std::count(code.begin(), code.begin() + endOfVersion, '\n') + 2;
+    return code.substr(0, endOfVersion + 1) + defines + "\n"
+        + "#line " + std::to_string(nextLine) + " 0\n" + code.substr(endOfVersion + 1);
+}
+
+std::string ProgramCache::getKey(const std::vector<std::string>& sources){
+    // FNV-1a, the sources are separated so moving a line between stages changes the key
+    uint64_t hash = 14695981039346656037ULL;
+    auto addBytes = [&hash](const std::string& bytes){
+        for(char byte : bytes){
+            hash ^= (unsigned char)byte;
+            hash *= 1099511628211ULL;
+        }
+        hash ^= 0xff;
+        hash *= 1099511628211ULL;
+    };
+    addBytes(getDriver());
+    for(const auto& source : sources){
+        addBytes(source);
+    }
+
+    char key[17];
+    snprintf(key, sizeof(key), "%016llx", (unsigned long long)hash);
+    return std::string(key);
+}
+
+bool ProgramCache::getIsFormatSupported(GLenum format){
+    GLint nbFormats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &nbFormats);
+    if(nbFormats <= 0) return false;
+    std::vector<GLint> formats(nbFormats);
+    glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, formats.data());
+    return std::find(formats.begin(), formats.end(), (GLint)format) != formats.end();
+}
+
+bool ProgramCache::load(GLuint program, const std::string& key){
+    if(!getIsEnabled()) return false;
+
+    std::ifstream file(getPath(key), std::ios::binary);
+    if(!file) return false;
+
+    // the driver is stored with the binary so a hash collision can't load a foreign binary
+    GLuint driverLength = 0;
+    file.read((char*)&driverLength, sizeof(GLuint));
+    std::string driver(driverLength, '\0');
+    file.read(&driver[0], driverLength);
+    if(!file || driver != getDriver()){
+        invalidate(key);
+        return false;
+    }
+
+    GLenum format = 0;
+    GLint length = 0;
+    file.read((char*)&format, sizeof(GLenum));
+    file.read((char*)&length, sizeof(GLint));
+    if(!file || length <= 0 || !getIsFormatSupported(format)){
+        invalidate(key);
+        return false;
+    }
+    std::vector<char> binary(length);
+    file.read(binary.data(), length);
+    if(!file){
+        invalidate(key);
+        return false;
+    }
+
+    // a binary the driver rejects only fails the link, the program is compiled instead
+    // the messages of the driver are muted in a debug group so the debug output doesn't treat a rejection as fatal
+    glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, "Program binary");
+    glDebugMessageControl(GL_DEBUG_SOURCE_API, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_FALSE);
+    glProgramBinary(program, format, binary.data(), length);
+    glPopDebugGroup();
+    GLint success = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if(success != GL_TRUE){
+        invalidate(key);
+        return false;
+    }
+    getNbLoadedRef()++;
+    return true;
+}
+
+void ProgramCache::invalidate(const std::string& key){
+    remove(getPath(key).c_str());
+}
+
+void ProgramCache::save(GLuint program, const std::string& key){
+    getNbCompiledRef()++;
+    if(!getIsEnabled()) return;
+
+    // some drivers don't have any binary format
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if(length <= 0) return;
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, nullptr, &format, binary.data());
+
+    mkdir(getDirectory().c_str(), 0755);
+    std::ofstream file(getPath(key), std::ios::binary);
+    std::string driver = getDriver();
+    GLuint driverLength = driver.size();
+    file.write((const char*)&driverLength, sizeof(GLuint));
+    file.write(driver.data(), driverLength);
+    file.write((const char*)&format, sizeof(GLenum));
+    file.write((const char*)&length, sizeof(GLint));
+    file.write(binary.data(), length);
+    if(!file){
+        fprintf(stderr, "Failed to write the program binary: %s!\n", getPath(key).c_str());
+        ErrorHandler::handle(ErrorCodes::IO_ERROR, ErrorLevel::WARNING);
+    }
+}
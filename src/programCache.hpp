@@ -0,0 +1,139 @@
+#pragma once
+
+#include <glad/gl.h>
+#include <string>
+#include <vector>
+
+/**
+ * A cache of the linked programs binaries on disk
+ * The entries are keyed by a hash of the driver and of the programs' sources,
+ * an entry that the driver refuses falls back to compiling the sources
+*/
+class ProgramCache{
+    private:
+        /**
+         * Private constructor to make the class purely static
+        */
+        ProgramCache(){};
+
+        static std::string& getDirectory(){
+            static std::string directory = "cache";
+            return directory;
+        }
+
+        static bool& getIsEnabled(){
+            static bool isEnabled = true;
+            return isEnabled;
+        }
+
+        static GLuint& getNbLoadedRef(){
+            static GLuint nbLoaded = 0;
+            return nbLoaded;
+        }
+
+        static GLuint& getNbCompiledRef(){
+            static GLuint nbCompiled = 0;
+            return nbCompiled;
+        }
+
+        /**
+         * Get the driver the binaries are valid for
+         * @return The renderer and the version of the GL context
+        */
+        static std::string getDriver();
+
+        /**
+         * Check a binary format against the ones of the driver, glProgramBinary fails with an error on the others
+         * @param format The format stored with the binary
+        */
+        static bool getIsFormatSupported(GLenum format);
+
+        static std::string getPath(const std::string& key){
+            return getDirectory() + "/" + key + ".bin";
+        }
+
+        /**
+         * Remove a stale entry, it is written again once the program is compiled
+         * @param key The program's key
+        */
+        static void invalidate(const std::string& key);
+
+        /**
+         * Expand the includes of a source, recursively
+         * @param code The source
+         * @param path The source's path
+         * @param sourceId The source string number of the #line directives, 0 for the shader
+         * @param includedPaths The files already expanded, in their order of inclusion
+         * @return The source with the included files
+        */
+        static std::string expandIncludes(const std::string& code, const std::string& path, GLuint sourceId,
+            std::vector<std::string>& includedPaths);
+
+    public:
+        /**
+         * Replace the #include "file" lines of a shader's source by the files, relative to the shader's directory
+         * A file is only expanded the first time it is included, and #line directives keep the numbering of each file
+         * The sources are expanded before they are hashed so editing an included file changes the key
+         * @param code The shader's source
+         * @param path The shader's path
+         * @return The source with the included files
+        */
+        static std::string addIncludes(const std::string& code, const std::string& path);
+
+        /**
+         * Add defines to a shader's source
+         * @param code The shader's source
+         * @param defines The lines added after the #version
+         * @return The source with the defines
+        */
+        static std::string addDefines(const std::string& code, const std::string& defines);
+
+        /**
+         * Get the key of a program
+         * @param sources The sources of every stage, with their defines
+         * @return The hash of the driver and of the sources
+        */
+        static std::string getKey(const std::vector<std::string>& sources);
+
+        /**
+         * Load a program from its binary
+         * @param program The program, not linked
+         * @param key The program's key
+         * @return True if the program is linked, false if it must be compiled
+        */
+        static bool load(GLuint program, const std::string& key);
+
+        /**
+         * Save the binary of a linked program
+         * The program must have been linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+         * @param program The program
+         * @param key The program's key
+        */
+        static void save(GLuint program, const std::string& key);
+
+        /**
+         * Set the directory of the cache
+         * @param directory The directory, created when the first binary is saved
+        */
+        static void setDirectory(const std::string& directory){
+            getDirectory() = directory;
+        }
+
+        static void setEnabled(bool isEnabled){
+            getIsEnabled() = isEnabled;
+        }
+
+        /**
+         * Get the number of programs loaded from their binary since the start
+        */
+        static GLuint getNbLoaded(){
+            return getNbLoadedRef();
+        }
+
+        /**
+         * Get the number of programs compiled from their sources since the start
+        */
+        static GLuint getNbCompiled(){
+            return getNbCompiledRef();
+        }
+};
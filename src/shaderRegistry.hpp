@@ -0,0 +1,49 @@
+#pragma once
+
+#include "computeShader.hpp"
+
+#include <string>
+#include <unordered_map>
+
+/**
+ * The programs shared by the whole application
+ * Each (path, defines) pair is compiled once, every user gets the same program
+*/
+class ShaderRegistry{
+    private:
+        /**
+         * Private constructor to make the class purely static
+        */
+        ShaderRegistry(){};
+
+        static std::unordered_map<std::string, ComputeShaderPointer>& getComputeShaders(){
+            static std::unordered_map<std::string, ComputeShaderPointer> computeShaders;
+            return computeShaders;
+        }
+
+    public:
+        /**
+         * Get a compute shader, compiled on the first request
+         * @param shaderPath The path to the compute shader
+         * @param defines The lines added after the shader's #version
+         * @return The shared program
+        */
+        static ComputeShaderPointer getComputeShader(const std::string& shaderPath, const std::string& defines = ""){
+            auto& computeShaders = getComputeShaders();
+            const std::string key = shaderPath + "\n" + defines;
+            auto it = computeShaders.find(key);
+            if(it != computeShaders.end()){
+                return it->second;
+            }
+            ComputeShaderPointer shader = ComputeShaderPointer(new ComputeShader(shaderPath, defines));
+            computeShaders[key] = shader;
+            return shader;
+        }
+
+        /**
+         * Release the registry's programs, must be called while the GL context exists
+        */
+        static void clear(){
+            getComputeShaders().clear();
+        }
+};
@@ -1,8 +1,9 @@
 #include "shaders.hpp"
+#include "programCache.hpp"
 #include <cstdlib>
 #include <fstream>
 
-Shaders::Shaders(const std::string& vert, const std::string& frag, const std::string& geom){
+Shaders::Shaders(const std::string& vert, const std::string& frag, const std::string& geom, const std::string& defines){
     _Id = glCreateProgram();
     _VertPath = vert;
     _FragPath = frag;
@@ -10,29 +11,32 @@ Shaders::Shaders(const std::string& vert, const std::string& frag, const std::st
     checkID("Failed to init the program!\n");
     bool hasGeom = geom.compare("") != 0;
 
-    const std::string vertCode = openShaderFile(vert);
-    const std::string fragCode = openShaderFile(frag);
-    const std::string geomCode = hasGeom ? openShaderFile(geom) : "";
+    const std::string vertCode = ProgramCache::addDefines(ProgramCache::addIncludes(openShaderFile(vert), vert), defines);
+    const std::string fragCode = ProgramCache::addDefines(ProgramCache::addIncludes(openShaderFile(frag), frag), defines);
+    const std::string geomCode = hasGeom
+        ? ProgramCache::addDefines(ProgramCache::addIncludes(openShaderFile(geom), geom), defines) : "";
 
-    GLuint vertID = compileShader(vertCode, ShaderType::VERT);
-    GLuint fragID = compileShader(fragCode, ShaderType::FRAG);
-    GLuint geomID = hasGeom ? compileShader(geomCode, ShaderType::GEOM) : -1;
+    const std::string key = ProgramCache::getKey({vertCode, fragCode, geomCode});
+    if(!ProgramCache::load(_Id, key)){
+        GLuint vertID = compileShader(vertCode, ShaderType::VERT);
+        GLuint fragID = compileShader(fragCode, ShaderType::FRAG);
+        GLuint geomID = hasGeom ? compileShader(geomCode, ShaderType::GEOM) : -1;
 
-    linkShaders(vertID, fragID, geomID);
+        glProgramParameteri(_Id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        linkShaders(vertID, fragID, geomID);
 
-    deleteShader(vertID);
-    deleteShader(fragID);
-    if(hasGeom)deleteShader(geomID);
+        deleteShader(vertID);
+        deleteShader(fragID);
+        if(hasGeom)deleteShader(geomID);
+        ProgramCache::save(_Id, key);
+    }
+    _Uniforms.resolve(_Id);
 }
 
 void Shaders::use() const {
     checkID("Can't use the shader before creating the program!\n");
     glUseProgram(_Id);
-    auto error = glGetError();
-    if (error != GL_NO_ERROR) {
-        fprintf(stderr, "Failed to use the shader!\n\tOpenGL error: %s\n", gluErrorString(error));
-        ErrorHandler::handle(ErrorCodes::GL_ERROR);
-    }
+    ErrorHandler::checkGLError("Failed to use the shader!");
 }
 
 
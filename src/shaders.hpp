@@ -8,6 +8,7 @@
 #include <iostream>
 
 #include "errorHandler.hpp"
+#include "uniformLocations.hpp"
 
 #include <glm/glm.hpp>
 #include <glm/ext.hpp>
@@ -33,14 +34,18 @@ class Shaders{
         std::string _FragPath = "";
         std::string _GeomPath = "";
 
+        // resolved once the program is linked, the uniforms are set without binding the program
+        UniformLocations _Uniforms;
+
     public:
         /**
-         * Basic constructor
+         * Basic constructor, the program is loaded from the program cache when it is there
          * @param vert The path to the vertex shader
          * @param frag The path to the fragment shader
          * @param geom The path to the geometry shader
+         * @param defines The lines added after the #version of every stage
         */
-        Shaders(const std::string& vert, const std::string& frag, const std::string& geom = "");
+        Shaders(const std::string& vert, const std::string& frag, const std::string& geom = "", const std::string& defines = "");
 
         /**
          * Basic destructor
@@ -67,11 +72,9 @@ class Shaders{
          * @param name The variable's name
          * @param val The variable's value
         */
-        void setBool(const std::string& name, bool val) const {
-            use();
+        void setBool(const UniformName& name, bool val) const {
             checkID("Can't set a uniform value before creating the program!\n");
-            glUniform1i(getUniformLocation(name), (GLuint)val);
-            checkError(name);
+            glProgramUniform1i(_Id, _Uniforms.get(name), (GLuint)val);
         }
 
         /**
@@ -79,11 +82,9 @@ class Shaders{
          * @param name The variable's name
          * @param val The variable's value
         */
-        void setInt(const std::string& name, int val) const {
-            use();
+        void setInt(const UniformName& name, int val) const {
             checkID("Can't set a uniform value before creating the program!\n");
-            glUniform1i(getUniformLocation(name), val);
-            checkError(name);
+            glProgramUniform1i(_Id, _Uniforms.get(name), val);
         }
 
         /**
@@ -91,11 +92,9 @@ class Shaders{
          * @param name The variable's name
          * @param val The variable's value
         */
-        void setFloat(const std::string& name, float val) const {
-            use();
+        void setFloat(const UniformName& name, float val) const {
             checkID("Can't set a uniform value before creating the program!\n");
-            glUniform1f(getUniformLocation(name), val);
-            checkError(name);
+            glProgramUniform1f(_Id, _Uniforms.get(name), val);
         }
 
         /**
@@ -103,11 +102,9 @@ class Shaders{
          * @param name The variable's name
          * @param val The variable's value
         */
-        void setMat4f(const std::string& name, const glm::mat4x4& val) const {
-            use();
+        void setMat4f(const UniformName& name, const glm::mat4x4& val) const {
             checkID("Can't set a uniform value before creating the program!\n");
-            glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, glm::value_ptr(val));
-            checkError(name);
+            glProgramUniformMatrix4fv(_Id, _Uniforms.get(name), 1, GL_FALSE, glm::value_ptr(val));
         }
 
         /**
@@ -115,11 +112,9 @@ class Shaders{
          * @param name The variable's name
          * @param val The variable's value
         */
-        void setVec3f(const std::string& name, const glm::vec3& val) const {
-            use();
+        void setVec3f(const UniformName& name, const glm::vec3& val) const {
             checkID("Can't set a uniform value before creating the program!\n");
-            glUniform3fv(getUniformLocation(name), 1, glm::value_ptr(val));
-            checkError(name);
+            glProgramUniform3fv(_Id, _Uniforms.get(name), 1, glm::value_ptr(val));
         }
 
         /**
@@ -127,11 +122,9 @@ class Shaders{
          * @param name The variable's name
          * @param val The variable's value
         */
-        void setVec4f(const std::string& name, const glm::vec4& val) const {
-            use();
+        void setVec4f(const UniformName& name, const glm::vec4& val) const {
             checkID("Can't set a uniform value before creating the program!\n");
-            glUniform4fv(getUniformLocation(name), 1, glm::value_ptr(val));
-            checkError(name);
+            glProgramUniform4fv(_Id, _Uniforms.get(name), 1, glm::value_ptr(val));
         }
 
     private:
@@ -178,21 +171,4 @@ class Shaders{
             }
         }
 
-        void checkError(const std::string& name) const{
-            auto error = glGetError();
-            if (error != GL_NO_ERROR) {
-                fprintf(stderr, "Failed to set %s!\n\tOpenGL error: %s\n", name.c_str(), gluErrorString(error));
-                ErrorHandler::handle(ErrorCodes::GL_ERROR);
-            }
-        }
-
-        GLint getUniformLocation(const std::string& name) const {
-            GLint uniformLocation = glGetUniformLocation(_Id, name.c_str());
-            if (uniformLocation == -1) {
-                fprintf(stderr, "Failed to set %s!\n\terror: Uniform not found!\n", name.c_str());
-                ErrorHandler::handle(ErrorCodes::GL_ERROR);
-            }
-            return uniformLocation;
-        }
-
 };
\ No newline at end of file
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <algorithm>
+#include <glad/gl.h>
+#include <vector>
+
+/**
+ * The clock of the animations, advanced by fixed steps decoupled from the frame rate
+ * The frame times are accumulated and consumed by steps, the rendering interpolates between the last two steps.
+ * The clock can be paused, scaled, and a recording of its frame times can be replayed to get the same steps again
+*/
+class SimulationClock{
+
+    public:
+        // steps of a frame after which the remaining time is dropped, the clock slows down instead of falling behind
+        static const GLuint _MAX_STEPS_PER_FRAME = 8;
+
+    private:
+        float _Step = 1.f / 60.f;
+        float _Scale = 1.f;
+        bool _IsPaused = false;
+        // double so the steps stay exact over long runs
+        double _Time = 0.0;
+        double _Accumulator = 0.0;
+        GLuint _NbFrameSteps = 0;
+
+        // scaled frame times added since the recording started, and the state it started from
+        bool _IsRecording = false;
+        bool _IsReplaying = false;
+        std::vector<float> _Recording;
+        GLuint _ReplayFrame = 0;
+        double _RecordingTime = 0.0;
+        double _RecordingAccumulator = 0.0;
+
+    public:
+        /**
+         * Basic constructor
+         * @param step The duration of a step in s
+        */
+        SimulationClock(float step = 1.f / 60.f) : _Step(step){}
+
+        /**
+         * Add the time of a frame, to be consumed by step
+         * Replaces it by the recorded one while replaying
+         * @param frameTime The real time of the frame in s
+        */
+        void addFrameTime(float frameTime){
+            _NbFrameSteps = 0;
+            if(_IsPaused) return;
+
+            float scaledTime = frameTime * _Scale;
+            if(_IsReplaying){
+                scaledTime = _Recording[_ReplayFrame++];
+                _IsReplaying = _ReplayFrame < _Recording.size();
+            }
+            if(_IsRecording){
+                _Recording.push_back(scaledTime);
+            }
+            _Accumulator += scaledTime;
+        }
+
+        /**
+         * Advance the clock by a step if the frame has enough time left
+         * @return True if the clock moved, the simulation must then be updated
+        */
+        bool step(){
+            if(_Accumulator < _Step) return false;
+            if(_NbFrameSteps == _MAX_STEPS_PER_FRAME){
+                _Accumulator = 0.0;
+                return false;
+            }
+            _Accumulator -= _Step;
+            _Time += _Step;
+            _NbFrameSteps++;
+            return true;
+        }
+
+        /**
+         * Get the time of the last step in s
+        */
+        float getTime() const {
+            return _Time;
+        }
+
+        /**
+         * Get the time to render in s, between the last two steps
+        */
+        float getInterpolatedTime() const {
+            double alpha = _Accumulator / _Step;
+            return std::max(0.0, (_Time - _Step) + alpha * _Step);
+        }
+
+        float getStep() const {
+            return _Step;
+        }
+
+        float getScale() const {
+            return _Scale;
+        }
+
+        bool getIsPaused() const {
+            return _IsPaused;
+        }
+
+        bool getIsRecording() const {
+            return _IsRecording;
+        }
+
+        bool getIsReplaying() const {
+            return _IsReplaying;
+        }
+
+        /**
+         * Set the speed of the time
+         * @param scale The simulated time per real time, positive
+        */
+        void setScale(float scale){
+            _Scale = scale;
+        }
+
+        void setPaused(bool isPaused){
+            _IsPaused = isPaused;
+        }
+
+        /**
+         * Record the frame times from now on, the previous recording is dropped
+        */
+        void startRecording(){
+            _IsRecording = true;
+            _IsReplaying = false;
+            _Recording.clear();
+            _RecordingTime = _Time;
+            _RecordingAccumulator = _Accumulator;
+        }
+
+        void stopRecording(){
+            _IsRecording = false;
+        }
+
+        /**
+         * Go back to the start of the recording and replay its frame times, the clock then runs again
+         * @return False if there is nothing recorded
+        */
+        bool replay(){
+            if(_Recording.empty()) return false;
+            _IsRecording = false;
+            _IsReplaying = true;
+            _ReplayFrame = 0;
+            _Time = _RecordingTime;
+            _Accumulator = _RecordingAccumulator;
+            return true;
+        }
+};
@@ -103,10 +103,11 @@ class Sun{
             _Shader->setVec3f("sunCol", _Color);
         }
 
-        void render(const glm::mat4& view, const glm::mat4& proj){
+        /**
+         * Draw the sun, the view and the projection are in the frame uniforms
+        */
+        void render(){
             _Shader->use();
-            _Shader->setMat4f("view", view);
-            _Shader->setMat4f("proj", proj);
             glBindVertexArray(_VAO);
             glDrawElements(GL_TRIANGLES, _Indices.size(), GL_UNSIGNED_INT, 0);
         }
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "frustum.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+#include <array>
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+/**
+ * The per frame state of the tiles evaluated by the cpu culling, one array per attribute
+ * Every tile is written by a single thread so ranges of tiles can be evaluated in parallel,
+ * nothing is allocated once the tiles are added
+*/
+struct TileArrays{
+    // bounding boxes of the tiles' blades, they stand on flat ground so the height is shared
+    std::vector<float> _MinX;
+    std::vector<float> _MinZ;
+    std::vector<float> _MaxX;
+    std::vector<float> _MaxZ;
+    float _MinY = 0.f;
+    float _MaxY = 0.f;
+
+    // index of each tile in the grid
+    std::vector<GLuint> _TileIndices;
+
+    // number of blades to draw
+    std::vector<GLuint> _NbBlades;
+
+    // bytes rather than std::vector<bool> so the threads don't share words
+    std::vector<GLubyte> _IsInRadius;
+    std::vector<GLubyte> _IsVisible;
+
+    // the visible tiles, indices in these arrays, the batch drawn this frame
+    std::vector<GLuint> _VisibleTiles;
+
+    /**
+     * Add a tile
+     * @param minCorner The corner of the tile's bounding box with the lowest coordinates
+     * @param maxCorner The corner of the tile's bounding box with the highest coordinates
+     * @param tileIndex The index of the tile in the grid
+    */
+    void add(const glm::vec3& minCorner, const glm::vec3& maxCorner, GLuint tileIndex){
+        _MinX.push_back(minCorner.x);
+        _MinZ.push_back(minCorner.z);
+        _MaxX.push_back(maxCorner.x);
+        _MaxZ.push_back(maxCorner.z);
+        _MinY = minCorner.y;
+        _MaxY = maxCorner.y;
+        _TileIndices.push_back(tileIndex);
+        _NbBlades.push_back(0);
+        _IsInRadius.push_back(0);
+        _IsVisible.push_back(0);
+        _VisibleTiles.reserve(_MinX.capacity());
+    }
+
+    GLuint size() const {
+        return _MinX.size();
+    }
+
+    /**
+     * Evaluate the blades count and visibility of a range of tiles
+     * @param first The first tile
+     * @param last The tile after the last one
+     * @param isInside True if the range is known to be within the render radius and the frustum
+     * @param cameraPosition The camera's position
+     * @param frustum The camera's frustum
+     * @param radiusRender The radius around the camera where the tiles are drawn
+     * @param maxNbBlades The number of blades of the tiles under the camera
+     * @param minNbBlades The number of blades of the tiles at the render radius
+    */
+    void evaluate(int first, int last, bool isInside,
+        const glm::vec3& cameraPosition, const Frustum& frustum,
+        float radiusRender, GLuint maxNbBlades, GLuint minNbBlades){
+        glm::vec3 groundCamPos = glm::vec3(cameraPosition.x, 0.f, cameraPosition.z);
+        for(int i=first; i<last; i++){
+            glm::vec3 minCorner = glm::vec3(_MinX[i], 0.f, _MinZ[i]);
+            glm::vec3 maxCorner = glm::vec3(_MaxX[i], 0.f, _MaxZ[i]);
+
+            // less blades for the tiles far from the camera
+            float dist = glm::distance(groundCamPos, 0.5f * (minCorner + maxCorner));
+            float alpha = std::min(dist / radiusRender, 1.f);
+            _NbBlades[i] = maxNbBlades * (1.f - alpha) + minNbBlades * alpha;
+
+            _IsInRadius[i] = isInside || doCircleRectangleIntersect(groundCamPos, radiusRender,
+                minCorner,
+                glm::vec3(maxCorner.x, 0.f, minCorner.z),
+                glm::vec3(minCorner.x, 0.f, maxCorner.z),
+                maxCorner
+            );
+        }
+        if(isInside){
+            std::fill(_IsVisible.begin() + first, _IsVisible.begin() + last, 1);
+        } else {
+            testFrustum(frustum, first, last);
+        }
+    }
+
+    /**
+     * Test the bounding boxes of a range of tiles within the render radius against the frustum
+     * A box is outside when its p-vertex, the corner furthest along a plane's normal, is behind the plane
+     * @param frustum The camera's frustum
+     * @param first The first tile
+     * @param last The tile after the last one
+    */
+    void testFrustum(const Frustum& frustum, int first, int last){
+        // the corner of every box to test is picked once per plane
+        std::array<Plane, 6> planes = frustum.getPlanes();
+        std::array<const float*, 6> pVertexX;
+        std::array<const float*, 6> pVertexZ;
+        std::array<float, 6> pVertexY;
+        for(int k=0; k<6; k++){
+            const glm::vec3& normal = planes[k]._Normal;
+            pVertexX[k] = normal.x >= 0.f ? _MaxX.data() : _MinX.data();
+            pVertexY[k] = normal.y >= 0.f ? _MaxY : _MinY;
+            pVertexZ[k] = normal.z >= 0.f ? _MaxZ.data() : _MinZ.data();
+        }
+
+        const GLubyte* isInRadius = _IsInRadius.data();
+        GLubyte* isVisible = _IsVisible.data();
+        #pragma omp simd
+        for(int i=first; i<last; i++){
+            bool visible = isInRadius[i] != 0;
+            for(int k=0; k<6; k++){
+                const glm::vec3& normal = planes[k]._Normal;
+                float dist = normal.x * pVertexX[k][i] + normal.y * pVertexY[k] + normal.z * pVertexZ[k][i];
+                visible &= dist >= planes[k]._Distance;
+            }
+            isVisible[i] = visible;
+        }
+    }
+};
@@ -0,0 +1,209 @@
+#pragma once
+
+#include "frustum.hpp"
+#include "tileArrays.hpp"
+
+#include <algorithm>
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+/**
+ * A quadtree over the tiles grid, the tiles of each node are contiguous in the tile arrays
+ * Whole nodes are rejected or accepted against the render radius and the frustum,
+ * only the leaves crossing their borders test their own tiles
+*/
+class TileQuadtree{
+
+    public:
+        // the leaves hold up to _LEAF_SIZE x _LEAF_SIZE tiles
+        static const GLuint _LEAF_SIZE = 8;
+        // below this number of tiles to evaluate the evaluation runs on a single thread
+        static const GLuint _MIN_NB_TILES_PARALLEL = 256;
+
+    private:
+        struct Node{
+            glm::vec3 _Min;
+            glm::vec3 _Max;
+            // range of the node's tiles in the tile arrays
+            GLuint _FirstTile;
+            GLuint _LastTile;
+            // the children are contiguous, no children for the leaves
+            GLuint _FirstChild;
+            GLuint _NbChildren;
+        };
+
+        // tiles of a node to evaluate this frame
+        struct Range{
+            GLuint _FirstTile;
+            GLuint _LastTile;
+            bool _IsInside;
+        };
+
+        std::vector<Node> _Nodes;
+        TileArrays _Arrays;
+
+        // traversal, reserved once built
+        std::vector<GLuint> _Stack;
+        std::vector<Range> _Ranges;
+
+    private:
+        /**
+         * Build the subtree over a block of tiles
+         * @param node The index of the subtree's root, already allocated
+        */
+        void build(GLuint node, GLuint minCol, GLuint minLine, GLuint maxCol, GLuint maxLine, GLuint nbCols,
+            const std::vector<glm::vec3>& minCorners, const std::vector<glm::vec3>& maxCorners){
+            GLuint nbNodeCols = maxCol - minCol;
+            GLuint nbNodeLines = maxLine - minLine;
+            _Nodes[node]._FirstTile = _Arrays.size();
+
+            // leaf, its tiles are added line by line
+            if(nbNodeCols <= _LEAF_SIZE && nbNodeLines <= _LEAF_SIZE){
+                glm::vec3 minCorner = minCorners[minLine * nbCols + minCol];
+                glm::vec3 maxCorner = maxCorners[minLine * nbCols + minCol];
+                for(GLuint line=minLine; line<maxLine; line++){
+                    for(GLuint col=minCol; col<maxCol; col++){
+                        GLuint tile = line * nbCols + col;
+                        _Arrays.add(minCorners[tile], maxCorners[tile], tile);
+                        minCorner = glm::min(minCorner, minCorners[tile]);
+                        maxCorner = glm::max(maxCorner, maxCorners[tile]);
+                    }
+                }
+                _Nodes[node]._LastTile = _Arrays.size();
+                _Nodes[node]._Min = minCorner;
+                _Nodes[node]._Max = maxCorner;
+                _Nodes[node]._FirstChild = 0;
+                _Nodes[node]._NbChildren = 0;
+                return;
+            }
+
+            // only the dimensions larger than a leaf are split
+            GLuint cols[3] = {minCol, maxCol, maxCol};
+            GLuint lines[3] = {minLine, maxLine, maxLine};
+            GLuint nbSplitCols = 1;
+            GLuint nbSplitLines = 1;
+            if(nbNodeCols > _LEAF_SIZE){
+                cols[1] = minCol + nbNodeCols / 2;
+                nbSplitCols = 2;
+            }
+            if(nbNodeLines > _LEAF_SIZE){
+                lines[1] = minLine + nbNodeLines / 2;
+                nbSplitLines = 2;
+            }
+
+            GLuint firstChild = _Nodes.size();
+            _Nodes.resize(firstChild + nbSplitCols * nbSplitLines);
+            _Nodes[node]._FirstChild = firstChild;
+            _Nodes[node]._NbChildren = nbSplitCols * nbSplitLines;
+
+            GLuint child = firstChild;
+            for(GLuint l=0; l<nbSplitLines; l++){
+                for(GLuint c=0; c<nbSplitCols; c++){
+                    build(child, cols[c], lines[l], cols[c+1], lines[l+1], nbCols, minCorners, maxCorners);
+                    child++;
+                }
+            }
+
+            _Nodes[node]._LastTile = _Arrays.size();
+            _Nodes[node]._Min = _Nodes[firstChild]._Min;
+            _Nodes[node]._Max = _Nodes[firstChild]._Max;
+            for(GLuint i=1; i<_Nodes[node]._NbChildren; i++){
+                _Nodes[node]._Min = glm::min(_Nodes[node]._Min, _Nodes[firstChild + i]._Min);
+                _Nodes[node]._Max = glm::max(_Nodes[node]._Max, _Nodes[firstChild + i]._Max);
+            }
+        }
+
+        bool isIntersectingCircle(const Node& node, const glm::vec3& center, float radius) const {
+            float dx = center.x - std::min(std::max(center.x, node._Min.x), node._Max.x);
+            float dz = center.z - std::min(std::max(center.z, node._Min.z), node._Max.z);
+            return dx * dx + dz * dz <= radius * radius;
+        }
+
+        bool isInsideCircle(const Node& node, const glm::vec3& center, float radius) const {
+            float dx = std::max(center.x - node._Min.x, node._Max.x - center.x);
+            float dz = std::max(center.z - node._Min.z, node._Max.z - center.z);
+            return dx * dx + dz * dz <= radius * radius;
+        }
+
+    public:
+        /**
+         * Build the quadtree over a grid of tiles
+         * @param nbCols The number of columns of the grid
+         * @param nbLines The number of lines of the grid
+         * @param minCorners The min corner of each tile's bounding box, line by line
+         * @param maxCorners The max corner of each tile's bounding box, line by line
+        */
+        void build(GLuint nbCols, GLuint nbLines,
+            const std::vector<glm::vec3>& minCorners, const std::vector<glm::vec3>& maxCorners){
+            _Nodes.clear();
+            _Arrays = TileArrays();
+            if(nbCols == 0 || nbLines == 0) return;
+
+            _Nodes.resize(1);
+            build(0, 0, 0, nbCols, nbLines, nbCols, minCorners, maxCorners);
+            _Stack.reserve(_Nodes.size());
+            _Ranges.reserve(_Nodes.size());
+        }
+
+        /**
+         * Evaluate the tiles within the render radius and the frustum, and list the visible ones
+         * @param cameraPosition The camera's position
+         * @param frustum The camera's frustum
+         * @param radiusRender The radius around the camera where the tiles are drawn
+         * @param maxNbBlades The number of blades of the tiles under the camera
+         * @param minNbBlades The number of blades of the tiles at the render radius
+        */
+        void evaluate(const glm::vec3& cameraPosition, const Frustum& frustum,
+            float radiusRender, GLuint maxNbBlades, GLuint minNbBlades){
+            _Arrays._VisibleTiles.clear();
+            if(_Nodes.empty()) return;
+            glm::vec3 groundCamPos = glm::vec3(cameraPosition.x, 0.f, cameraPosition.z);
+
+            // the nodes crossing a border are split down to the leaves
+            _Ranges.clear();
+            GLuint nbTiles = 0;
+            _Stack.push_back(0);
+            while(!_Stack.empty()){
+                const Node& node = _Nodes[_Stack.back()];
+                _Stack.pop_back();
+
+                if(!isIntersectingCircle(node, groundCamPos, radiusRender)) continue;
+                FrustumTest test = frustum.testBox(node._Min, node._Max);
+                if(test == FRUSTUM_OUTSIDE) continue;
+
+                bool isInside = test == FRUSTUM_INSIDE && isInsideCircle(node, groundCamPos, radiusRender);
+                if(isInside || node._NbChildren == 0){
+                    _Ranges.push_back({node._FirstTile, node._LastTile, isInside});
+                    nbTiles += node._LastTile - node._FirstTile;
+                    continue;
+                }
+                for(GLuint i=0; i<node._NbChildren; i++){
+                    _Stack.push_back(node._FirstChild + i);
+                }
+            }
+
+            // each range only writes its own tiles
+            int nbRanges = _Ranges.size();
+            #pragma omp parallel for schedule(dynamic) if(nbTiles >= _MIN_NB_TILES_PARALLEL)
+            for(int i=0; i<nbRanges; i++){
+                const Range& range = _Ranges[i];
+                _Arrays.evaluate(range._FirstTile, range._LastTile, range._IsInside,
+                    cameraPosition, frustum, radiusRender, maxNbBlades, minNbBlades);
+            }
+
+            for(const Range& range : _Ranges){
+                for(GLuint i=range._FirstTile; i<range._LastTile; i++){
+                    if(_Arrays._IsVisible[i]) _Arrays._VisibleTiles.push_back(i);
+                }
+            }
+        }
+
+        const TileArrays& getArrays() const {
+            return _Arrays;
+        }
+
+        GLuint getNbNodes() const {
+            return _Nodes.size();
+        }
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "errorHandler.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <glad/gl.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * The name of a uniform with its hash
+ * The hash of a string literal can be computed at compile time
+*/
+struct UniformName{
+    const char* _Name;
+    uint64_t _Hash;
+
+    /**
+     * FNV-1a of a null terminated string
+    */
+    static constexpr uint64_t hash(const char* name, uint64_t value = 14695981039346656037ULL){
+        return *name == '\0' ? value : hash(name + 1, (value ^ (unsigned char)*name) * 1099511628211ULL);
+    }
+
+    constexpr UniformName(const char* name) : _Name(name), _Hash(hash(name)) {}
+
+    UniformName(const std::string& name) : _Name(name.c_str()), _Hash(hash(name.c_str())) {}
+};
+
+/**
+ * The locations of the active uniforms of a program, resolved once it is linked
+*/
+class UniformLocations{
+
+    private:
+        // the names missing from the program are added with -1 when first set, so they are only reported once
+        mutable std::unordered_map<uint64_t, GLint> _Locations;
+
+    public:
+        /**
+         * Query the locations of every active uniform of a program
+         * The elements of the arrays are added one by one, and the array's name is its first element
+         * @param program The linked program
+        */
+        void resolve(GLuint program){
+            _Locations.clear();
+            GLint nbUniforms = 0;
+            GLint maxLength = 0;
+            glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &nbUniforms);
+            glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+            std::vector<char> name(maxLength + 1);
+
+            for(GLint i=0; i<nbUniforms; i++){
+                GLsizei length = 0;
+                GLint size = 0;
+                GLenum type = 0;
+                glGetActiveUniform(program, i, maxLength, &length, &size, &type, name.data());
+                std::string uniformName(name.data(), length);
+                // the members of the uniform blocks have no location
+                GLint location = glGetUniformLocation(program, uniformName.c_str());
+                if(location == -1) continue;
+                _Locations[UniformName::hash(uniformName.c_str())] = location;
+
+                const std::string suffix = "[0]";
+                if(uniformName.size() <= suffix.size()) continue;
+                if(uniformName.compare(uniformName.size() - suffix.size(), suffix.size(), suffix) != 0) continue;
+                std::string arrayName = uniformName.substr(0, uniformName.size() - suffix.size());
+                _Locations[UniformName::hash(arrayName.c_str())] = location;
+                for(GLint j=1; j<size; j++){
+                    std::string elementName = arrayName + "[" + std::to_string(j) + "]";
+                    _Locations[UniformName::hash(elementName.c_str())] = glGetUniformLocation(program, elementName.c_str());
+                }
+            }
+        }
+
+        /**
+         * Get the location of a uniform
+         * A uniform the compiler removed or a define disabled is reported once, glProgramUniform ignores its -1
+         * @param name The uniform's name
+         * @return The location, -1 if the uniform is not active
+        */
+        GLint get(const UniformName& name) const {
+            auto it = _Locations.find(name._Hash);
+            if(it == _Locations.end()){
+                fprintf(stderr, "Failed to set %s!\n\terror: Uniform not found!\n", name._Name);
+                ErrorHandler::handle(ErrorCodes::GL_ERROR, ErrorLevel::WARNING);
+                _Locations[name._Hash] = -1;
+                return -1;
+            }
+            return it->second;
+        }
+};
@@ -1,4 +1,5 @@
 #include "utils.hpp"
+#include <algorithm>
 #include <iostream>
 #include <glm/geometric.hpp>
 
@@ -10,17 +11,16 @@ bool doCircleRectangleIntersect(
             const glm::vec3& rectangleDownLeft,
             const glm::vec3& rectangleDownRight){
 
-    float rectWidth = rectangleUpRight.x - rectangleUpLeft.x;
-    float rectHeight = rectangleUpLeft.z - rectangleDownLeft.z;
-    float rectHalfWidth = rectWidth / 2.f;
-    float rectHalfHeight = rectHeight / 2.f;
-    glm::vec3 rectCenter = rectangleUpLeft + glm::vec3(rectHalfWidth, 0.f, rectHalfHeight);
+    float minX = std::min(std::min(rectangleUpLeft.x, rectangleUpRight.x), std::min(rectangleDownLeft.x, rectangleDownRight.x));
+    float maxX = std::max(std::max(rectangleUpLeft.x, rectangleUpRight.x), std::max(rectangleDownLeft.x, rectangleDownRight.x));
+    float minZ = std::min(std::min(rectangleUpLeft.z, rectangleUpRight.z), std::min(rectangleDownLeft.z, rectangleDownRight.z));
+    float maxZ = std::max(std::max(rectangleUpLeft.z, rectangleUpRight.z), std::max(rectangleDownLeft.z, rectangleDownRight.z));
 
-    float distRectCicrle = glm::distance(circleCenter, rectCenter);
-    if(distRectCicrle > circleRadius) return false;
-    if(distRectCicrle > circleRadius) return false;
+    // distance to the closest point of the rectangle, null if the center is inside
+    float dx = circleCenter.x - std::min(std::max(circleCenter.x, minX), maxX);
+    float dz = circleCenter.z - std::min(std::max(circleCenter.z, minZ), maxZ);
 
-    return true;
+    return dx * dx + dz * dz <= circleRadius * circleRadius;
 }
 
 void displayTime(std::chrono::high_resolution_clock::time_point start,
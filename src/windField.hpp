@@ -0,0 +1,111 @@
+#pragma once
+
+#include "computeShader.hpp"
+#include "errorHandler.hpp"
+#include "shaderRegistry.hpp"
+
+#include <glad/gl.h>
+#include <string>
+
+/**
+ * @enum How the blades get the wind
+*/
+enum WindMode{
+    WIND_MODE_TEXTURE,      // one fetch in the wind texture
+    WIND_MODE_ANALYTIC,     // the simplex noise octaves, per vertex
+    WIND_MODE_COMPARE,      // the texture, the blades are tinted by its difference with the noise
+};
+
+/**
+ * The wind of the frame, rendered once by a compute pass into a texture sampled by the blades
+ * The texture is a window of _EXTENT meters around the camera, which scrolls with it:
+ * the window wraps around the edges of the texture so the blades sample it at their position with a repeat
+*/
+class WindField{
+
+    public:
+        // texels of a side of the texture, a power of two
+        static const GLuint _SIZE = 256;
+        // meters covered by the texture, at least the diameter of the render radius plus the reach of the blades
+        static constexpr float _EXTENT = 80.f;
+        static const GLuint _TEXTURE_UNIT = 4;
+
+    private:
+        WindMode _Mode = WIND_MODE_TEXTURE;
+        GLuint _Texture = 0;
+        ComputeShaderPointer _Shader = nullptr;
+
+    public:
+        WindField(){
+            glCreateTextures(GL_TEXTURE_2D, 1, &_Texture);
+            glTextureStorage2D(_Texture, 1, GL_R16F, _SIZE, _SIZE);
+            glTextureParameteri(_Texture, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTextureParameteri(_Texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTextureParameteri(_Texture, GL_TEXTURE_WRAP_S, GL_REPEAT);
+            glTextureParameteri(_Texture, GL_TEXTURE_WRAP_T, GL_REPEAT);
+            glBindTextureUnit(_TEXTURE_UNIT, _Texture);
+            ErrorHandler::checkGLError("Failed to init the wind texture!");
+
+            _Shader = ShaderRegistry::getComputeShader("shader/grassWind.glsl", getDefines(WIND_MODE_TEXTURE));
+        }
+
+        ~WindField(){
+            glDeleteTextures(1, &_Texture);
+        }
+
+        WindField(const WindField&) = delete;
+        WindField& operator=(const WindField&) = delete;
+
+        /**
+         * Get the defines of the shaders sampling the wind
+         * @param mode The wind mode
+        */
+        static std::string getDefines(WindMode mode){
+            return "#define WIND_MODE " + std::to_string((int)mode) + "\n"
+                + "#define WIND_SIZE " + std::to_string(_SIZE) + "\n"
+                + "#define WIND_EXTENT " + std::to_string(_EXTENT);
+        }
+
+        /**
+         * Get the distance to the camera up to which the blades sample the wind of their own position
+         * The window is snapped to the texels and the linear filtering reads a texel further, two texels are kept as margin
+         * @return The distance in meters
+        */
+        static float getMaxDistance(){
+            return 0.5f * _EXTENT - 2.f * _EXTENT / _SIZE;
+        }
+
+        /**
+         * Parse a wind mode
+         * @param value The mode's name, texture, analytic or compare
+         * @param mode The mode
+         * @return False if the name is unknown
+        */
+        static bool parseMode(const std::string& value, WindMode& mode){
+            if(value == "texture") mode = WIND_MODE_TEXTURE;
+            else if(value == "analytic") mode = WIND_MODE_ANALYTIC;
+            else if(value == "compare") mode = WIND_MODE_COMPARE;
+            else return false;
+            return true;
+        }
+
+        /**
+         * Render the wind of the frame around the camera, the frame uniforms must be up to date
+         * Nothing is rendered when the blades compute the noise themselves
+        */
+        void update(){
+            if(_Mode == WIND_MODE_ANALYTIC) return;
+            _Shader->use();
+            glBindImageTexture(0, _Texture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R16F);
+            glDispatchCompute(_SIZE / 16, _SIZE / 16, 1);
+            glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+        }
+
+        void setMode(WindMode mode){
+            _Mode = mode;
+        }
+
+        WindMode getMode() const {
+            return _Mode;
+        }
+};